@@ -0,0 +1,19 @@
+# SERVER_IO_URING, shared by every project that compiles server sources.
+#
+# Asio then runs sockets, timers and accept on io_uring instead of epoll. The
+# reactor is fixed at compile time, so every translation unit that includes
+# Asio must see the same definitions; include this before adding targets and
+# link ${SERVER_IO_URING_LIBRARIES}.
+option(SERVER_IO_URING "Run socket I/O on io_uring instead of epoll (Linux, needs liburing)" OFF)
+
+set(SERVER_IO_URING_LIBRARIES)
+if(SERVER_IO_URING)
+    if(NOT CMAKE_SYSTEM_NAME STREQUAL "Linux")
+        message(FATAL_ERROR "SERVER_IO_URING is only available on Linux")
+    endif()
+    find_path(URING_INCLUDE_DIR liburing.h REQUIRED)
+    find_library(URING_LIBRARY uring REQUIRED)
+    include_directories(${URING_INCLUDE_DIR})
+    add_definitions(-DSERVER_IO_URING -DBOOST_ASIO_HAS_IO_URING -DBOOST_ASIO_DISABLE_EPOLL)
+    set(SERVER_IO_URING_LIBRARIES ${URING_LIBRARY})
+endif()
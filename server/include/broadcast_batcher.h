@@ -0,0 +1,45 @@
+#ifndef BROADCAST_BATCHER_H
+#define BROADCAST_BATCHER_H
+
+#include "broadcast_message.h"
+#include "delivery_executor.h"
+#include "room_options.h"
+#include <vector>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+class SocketConnection;
+
+// Packs a room's broadcasts into one frame per flush, so each member gets one
+// write for many messages. The first message of a batch arms a timer on the
+// room's delivery shard; the batch goes out when the timer fires or a size cap
+// is reached, to the members of the latest snapshot handed in. A batch of one
+// is delivered as the plain message.
+//
+// Holds everything it needs to deliver, so a pending flush never touches the
+// room. Add must be called in delivery order.
+class BroadcastBatcher : public boost::enable_shared_from_this<BroadcastBatcher> {
+public:
+    using MemberList = std::vector<boost::weak_ptr<SocketConnection>>;
+
+    BroadcastBatcher(DeliveryExecutor::Shard shard, BatchOptions options);
+
+    void Add(BroadcastMessagePtr message, boost::shared_ptr<const MemberList> members);
+    void Flush();
+
+private:
+    void FlushLocked();
+
+    DeliveryExecutor::Shard shard_;
+    BatchOptions options_;
+
+    boost::mutex mutex_;
+    std::vector<BroadcastMessagePtr> pending_;
+    size_t pending_bytes_ = 0;
+    boost::shared_ptr<const MemberList> members_;
+    uint64_t generation_ = 0;
+    boost::asio::steady_timer timer_;
+};
+
+#endif // BROADCAST_BATCHER_H
@@ -0,0 +1,89 @@
+#ifndef BROADCAST_MESSAGE_H
+#define BROADCAST_MESSAGE_H
+
+#include "wire_codec.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <boost/asio/buffer.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+struct ThreadMessagePool;
+class BroadcastMessage;
+
+using BroadcastMessagePtr = boost::intrusive_ptr<const BroadcastMessage>;
+
+// Immutable payload shared by every recipient of a broadcast. Queued writes
+// and history entries hold references, and the last release frees it or
+// hands it back to MessagePool.
+class BroadcastMessage {
+public:
+    explicit BroadcastMessage(
+        std::string payload,
+        WireProtocol encoding = WireProtocol::Json,
+        std::string sender = {}
+    );
+    BroadcastMessage(std::string json_payload, std::string binary_payload);
+    // A batch of parts; each encoding is built from them on first use.
+    explicit BroadcastMessage(std::vector<BroadcastMessagePtr> parts);
+
+    BroadcastMessage(const BroadcastMessage&) = delete;
+    BroadcastMessage& operator=(const BroadcastMessage&) = delete;
+
+    const std::string& Data() const;
+    boost::asio::const_buffer Buffer() const;
+    boost::asio::const_buffer BufferFor(WireProtocol protocol) const;
+    size_t Size() const;
+    WireProtocol Encoding() const;
+    const std::string& Sender() const;
+    uint32_t UseCount() const;
+    // When a pooled message's frame was read; unset for other messages.
+    std::chrono::steady_clock::time_point ReceivedAt() const;
+
+    friend void intrusive_ptr_add_ref(const BroadcastMessage* message);
+    friend void intrusive_ptr_release(const BroadcastMessage* message);
+
+private:
+    friend class MessagePool;
+    friend struct ThreadMessagePool;
+
+    BroadcastMessage() = default;
+
+    void Assign(std::string_view payload, WireProtocol encoding, std::string_view sender);
+    size_t RetainedCapacity() const;
+    const std::string& Transcoded() const;
+    std::string EncodeBatch(WireProtocol protocol) const;
+
+    // Mutable only so a batch can fill it on first use.
+    mutable std::string payload_;
+    WireProtocol encoding_ = WireProtocol::Json;
+    std::string sender_;
+    std::chrono::steady_clock::time_point received_at_{};
+    // The pool the message returns to on its last release, if any.
+    ThreadMessagePool* pool_ = nullptr;
+    BroadcastMessage* next_returned_ = nullptr;
+    std::vector<BroadcastMessagePtr> parts_;
+    // Fixed up front so queue accounting does not depend on which encoding
+    // a batch ends up building.
+    size_t batch_size_ = 0;
+
+    // Intrusive, so a message needs no separate control block.
+    mutable std::atomic<uint32_t> ref_count_{0};
+    mutable std::atomic<bool> payload_ready_{true};
+    // The payload is kept in the encoding it arrived in; the other one is
+    // produced on first use and shared by every recipient that needs it.
+    mutable std::atomic<bool> transcoded_ready_{false};
+    mutable boost::mutex transcode_mutex_;
+    mutable std::string transcoded_;
+};
+
+BroadcastMessagePtr MakeBroadcastMessage(std::string payload);
+BroadcastMessagePtr MakeBroadcastMessage(std::string payload, WireProtocol encoding, std::string sender);
+BroadcastMessagePtr MakeDualEncodedMessage(std::string json_payload, std::string binary_payload);
+// JSON clients get an array of the messages, binary clients a RoomMessageBatch.
+BroadcastMessagePtr MakeBatchMessage(const std::vector<BroadcastMessagePtr>& messages);
+
+#endif // BROADCAST_MESSAGE_H
@@ -4,8 +4,6 @@
 #include "headers.h"
 #include "socket_connection.h"
 #include <boost/atomic.hpp>
-#include <boost/thread.hpp>
-#include <vector>
 
 class SocketConnection;
 
@@ -16,29 +14,30 @@ public:
     ConnectionAcceptor(
         io_context& io_context,
         const ip::tcp::endpoint& endpoint,
-        size_t thread_pool_size = boost::thread::hardware_concurrency()
+        bool reuse_port = false,
+        ConnectionOptions connection_options = {}
     );
 
     ~ConnectionAcceptor();
 
     void Start();
+    void StopAccepting();
     void Stop();
+    io_context& GetContext() const;
 
 private:
-    void InitAcceptor();
+    void InitAcceptor(bool reuse_port);
     void AsyncAccept();
     void HandleAccept(
         const boost::shared_ptr<ip::tcp::socket>& socket,
         const boost::system::error_code& error
     );
     void ProcessConnection(const boost::shared_ptr<SocketConnection>& connection) const;
-    void WorkerThread() const;
 
     io_context& io_context_;
     ip::tcp::acceptor acceptor_;
     boost::atomic<bool> is_accepting_{false};
-    std::vector<std::thread> worker_threads_;
-    size_t thread_pool_size_;
+    ConnectionOptions connection_options_;
 };
 
 #endif // CONNECTION_ACCEPTOR_H
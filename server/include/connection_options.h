@@ -0,0 +1,37 @@
+#ifndef CONNECTION_OPTIONS_H
+#define CONNECTION_OPTIONS_H
+
+#include "room_options.h"
+#include "token_bucket.h"
+#include <chrono>
+#include <cstddef>
+
+enum class OverflowPolicy {
+    DropNewest,
+    DropOldest,
+    Disconnect
+};
+
+// permessage-deflate (RFC 7692). The server never keeps its compression
+// context between messages, so each connection holds no sliding window for
+// egress and every message is compressed on its own.
+struct DeflateOptions {
+    bool enabled = false;
+    int window_bits = 15;
+    int mem_level = 4;
+};
+
+struct ConnectionOptions {
+    size_t max_queued_bytes = 4 * 1024 * 1024;
+    OverflowPolicy overflow_policy = OverflowPolicy::Disconnect;
+    std::chrono::milliseconds ping_interval{5000};
+    std::chrono::milliseconds idle_timeout{10000};
+    size_t max_frame_bytes = 1024 * 1024;
+    DeflateOptions deflate;
+    // What one connection may send.
+    InboundLimits inbound;
+    // Settings for the rooms this connection creates.
+    RoomOptions room;
+};
+
+#endif // CONNECTION_OPTIONS_H
@@ -0,0 +1,45 @@
+#ifndef CONNECTION_REGISTRY_H
+#define CONNECTION_REGISTRY_H
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+class SocketConnection;
+
+// Every accepted connection, so shutdown can reach the ones that never joined
+// a room. Split into shards by address; connections register once after
+// accept and unregister from their destructor.
+class ConnectionRegistry {
+public:
+    ConnectionRegistry(const ConnectionRegistry&) = delete;
+    ConnectionRegistry& operator=(const ConnectionRegistry&) = delete;
+
+    static ConnectionRegistry& GetInstance();
+
+    void Register(const boost::shared_ptr<SocketConnection>& connection);
+    void Unregister(const SocketConnection* connection);
+
+    std::vector<boost::weak_ptr<SocketConnection>> Snapshot() const;
+    size_t Size() const;
+
+private:
+    ConnectionRegistry() = default;
+
+    struct alignas(64) Shard {
+        mutable boost::mutex mutex;
+        std::unordered_map<const SocketConnection*, boost::weak_ptr<SocketConnection>> connections;
+    };
+
+    static constexpr size_t kShardCount = 16;
+
+    Shard& ShardFor(const SocketConnection* connection);
+
+    std::array<Shard, kShardCount> shards_;
+    boost::atomic<size_t> size_{0};
+};
+
+#endif // CONNECTION_REGISTRY_H
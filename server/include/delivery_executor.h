@@ -0,0 +1,36 @@
+#ifndef DELIVERY_EXECUTOR_H
+#define DELIVERY_EXECUTOR_H
+
+#include <string_view>
+#include <vector>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+// Server-wide pool that runs room deliveries. Work is spread over a fixed set
+// of strands; a room always maps to the same strand, so its messages keep
+// their order without the room owning any threads.
+class DeliveryExecutor {
+public:
+    using Shard = boost::asio::strand<boost::asio::thread_pool::executor_type>;
+
+    explicit DeliveryExecutor(size_t thread_count, size_t shard_count);
+    ~DeliveryExecutor();
+
+    DeliveryExecutor(const DeliveryExecutor&) = delete;
+    DeliveryExecutor& operator=(const DeliveryExecutor&) = delete;
+
+    static DeliveryExecutor& GetInstance();
+
+    Shard ShardFor(std::string_view key) const;
+    size_t ThreadCount() const;
+    size_t ShardCount() const;
+
+    void Stop();
+
+private:
+    size_t thread_count_;
+    boost::asio::thread_pool pool_;
+    std::vector<Shard> shards_;
+};
+
+#endif // DELIVERY_EXECUTOR_H
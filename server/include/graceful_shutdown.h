@@ -0,0 +1,39 @@
+#ifndef GRACEFUL_SHUTDOWN_H
+#define GRACEFUL_SHUTDOWN_H
+
+#include "server_options.h"
+#include <functional>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/smart_ptr.hpp>
+
+class SocketConnection;
+
+// Drains the server after accepting has stopped. Every registered connection
+// is asked to flush its send queue and then send a "going away" close frame;
+// requests go out in batches so clients do not all reconnect at once. Done
+// when the last connection is gone or the drain deadline passes, whichever
+// comes first. Runs on one single-threaded io_context.
+class GracefulShutdown : public boost::enable_shared_from_this<GracefulShutdown> {
+public:
+    GracefulShutdown(boost::asio::io_context& ctx, ShutdownOptions options, std::function<void(bool drained)> on_complete);
+
+    void Start();
+    void Abort();
+
+private:
+    void CloseNextBatch();
+    void AwaitDrain();
+    void Finish(bool drained);
+
+    boost::asio::steady_timer batch_timer_;
+    boost::asio::steady_timer deadline_timer_;
+    ShutdownOptions options_;
+    std::function<void(bool drained)> on_complete_;
+    std::vector<boost::weak_ptr<SocketConnection>> connections_;
+    size_t next_connection_ = 0;
+    bool finished_ = false;
+};
+
+#endif // GRACEFUL_SHUTDOWN_H
@@ -0,0 +1,71 @@
+#ifndef HEARTBEAT_MANAGER_H
+#define HEARTBEAT_MANAGER_H
+
+#include "timer_wheel.h"
+#include <array>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+class SocketConnection;
+
+// Drives heartbeats and idle timeouts for every connection from timer wheels
+// ticking on one thread of their own. Due connections are handed back to their
+// own executor in a batch per tick; the reactor's timer queue is not involved.
+//
+// Connections are spread over shards, each with its own lock and wheel, so
+// connections on different io threads rarely contend. A shard keeps its
+// targets in a pool indexed by the wheel payload; once warmed up, Schedule
+// and Cancel do not allocate.
+class HeartbeatManager {
+public:
+    struct Handle {
+        TimerWheel::Handle timer;
+        uint32_t shard = 0;
+    };
+
+    explicit HeartbeatManager(
+        std::chrono::milliseconds tick = std::chrono::milliseconds(100),
+        size_t slot_count = 512
+    );
+    ~HeartbeatManager();
+
+    HeartbeatManager(const HeartbeatManager&) = delete;
+    HeartbeatManager& operator=(const HeartbeatManager&) = delete;
+
+    static HeartbeatManager& GetInstance();
+
+    Handle Schedule(const boost::shared_ptr<SocketConnection>& connection, std::chrono::milliseconds delay);
+    void Cancel(Handle handle);
+    size_t Size() const;
+
+private:
+    struct alignas(64) Shard {
+        mutable boost::mutex mutex;
+        TimerWheel wheel{1};
+        std::vector<boost::weak_ptr<SocketConnection>> targets;
+        std::vector<uint32_t> free_targets;
+
+        void Release(uint32_t target);
+    };
+
+    static constexpr size_t kShardCount = 16;
+
+    static uint32_t ShardFor(const SocketConnection* connection);
+    void ArmTicker();
+    void Tick();
+
+    std::chrono::milliseconds tick_;
+    std::array<Shard, kShardCount> shards_;
+
+    boost::asio::io_context ticker_context_;
+    boost::asio::steady_timer ticker_;
+    std::chrono::steady_clock::time_point next_tick_;
+    std::thread ticker_thread_;
+};
+
+#endif // HEARTBEAT_MANAGER_H
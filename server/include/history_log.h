@@ -0,0 +1,109 @@
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include "broadcast_message.h"
+#include "message_history.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+struct HistoryLogOptions {
+    std::string directory;
+    size_t segment_bytes = 64 * 1024 * 1024;
+    // Sealed segments beyond this count are deleted, oldest first.
+    size_t max_segments = 16;
+    // Appends wait at most this long for others to share their fsync.
+    std::chrono::milliseconds commit_window{2};
+    // Appends are dropped, and counted, while this much is waiting for disk.
+    size_t max_pending_bytes = 32 * 1024 * 1024;
+};
+
+struct RecoveredRoom {
+    std::string name;
+    std::vector<BroadcastMessagePtr> messages;
+};
+
+// Append-only record of every room message, kept in numbered segment files.
+// Append copies the record into a pending buffer and returns; one writer
+// thread gathers everything pending, writes it with a single call and syncs
+// once per batch. When a segment is sealed an index of how many records each
+// room has in it is written next to it.
+//
+// Replay maps the segments newest first and takes only each room's tail: a
+// sealed segment whose rooms all have enough newer records is skipped by its
+// index alone, and inside a segment records older than a room's tail are
+// stepped over by header. A segment cut short by a crash is read up to its
+// last complete record, and a record that fails its checksum is skipped and
+// logged; the writer never appends to an existing segment.
+//
+// Replayed tails are staged on the log rather than turned into rooms: a room
+// takes its tail when it is next created, so rooms that were gone before the
+// restart stay gone.
+class HistoryLog {
+public:
+    explicit HistoryLog(HistoryLogOptions options);
+    ~HistoryLog();
+
+    HistoryLog(const HistoryLog&) = delete;
+    HistoryLog& operator=(const HistoryLog&) = delete;
+
+    // The log rooms write to, or nullptr when persistence is off.
+    static HistoryLog* Active();
+    static void SetActive(HistoryLog* log);
+
+    static std::vector<RecoveredRoom> Replay(const std::string& directory, size_t tail_messages);
+
+    void Stage(std::vector<RecoveredRoom> rooms);
+    // The staged tail for the room, handed out once.
+    std::vector<BroadcastMessagePtr> TakeRecovered(std::string_view room);
+
+    void Append(std::string_view room, const BroadcastMessage& message);
+
+    // Blocks until every record appended before the call is on disk.
+    void Flush();
+
+    uint64_t Written() const;
+    uint64_t Dropped() const;
+
+private:
+    void OpenSegment();
+    void SealSegment();
+    bool WriteBatch(std::string_view batch);
+    void CountRooms(std::string_view batch);
+    void EnforceRetention();
+    void WriterLoop();
+
+    HistoryLogOptions options_;
+
+    boost::mutex mutex_;
+    boost::condition_variable pending_ready_;
+    boost::condition_variable committed_;
+    std::string pending_;
+    uint64_t appended_ = 0;
+    uint64_t committed_records_ = 0;
+    uint64_t pending_records_ = 0;
+    bool stopping_ = false;
+
+    boost::mutex recovered_mutex_;
+    std::map<std::string, std::vector<BroadcastMessagePtr>, std::less<>> recovered_;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    // Owned by the writer thread.
+    int segment_fd_ = -1;
+    uint64_t segment_id_ = 0;
+    size_t segment_size_ = 0;
+    std::map<std::string, uint32_t, std::less<>> segment_rooms_;
+
+    std::thread writer_;
+};
+
+#endif // HISTORY_LOG_H
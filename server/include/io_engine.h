@@ -0,0 +1,70 @@
+#ifndef IO_ENGINE_H
+#define IO_ENGINE_H
+
+#include "server_options.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/thread/mutex.hpp>
+
+// Owns every io thread of the server. In shared mode all threads run one
+// io_context; in per-core mode each thread runs its own single-threaded
+// io_context. With pin_cpus thread i is bound to CPU i modulo the core count.
+//
+// Utilization is measured from each thread's CPU clock: an io thread only
+// burns CPU while running handlers, so CPU time over wall time is the share
+// of time it was busy.
+class IoEngine {
+public:
+    struct ThreadUsage {
+        size_t thread;
+        size_t context;
+        int cpu;
+        double busy_seconds;
+        double wall_seconds;
+
+        double Utilization() const;
+    };
+
+    explicit IoEngine(IoEngineOptions options);
+    ~IoEngine();
+
+    IoEngine(const IoEngine&) = delete;
+    IoEngine& operator=(const IoEngine&) = delete;
+
+    // The engine the metrics endpoint reports on, or nullptr.
+    static IoEngine* Active();
+    static void SetActive(IoEngine* engine);
+
+    // The reactor Asio was built with: "io_uring" with SERVER_IO_URING,
+    // otherwise "epoll", "kqueue" or "select".
+    static const char* BackendName();
+
+    size_t ThreadCount() const;
+    size_t ContextCount() const;
+    boost::asio::io_context& Context(size_t index) const;
+
+    void Start();
+    // Stops every io_context and joins the threads.
+    void Stop();
+
+    // Empty unless the engine is running.
+    std::vector<ThreadUsage> Usage() const;
+
+private:
+    void Run(size_t thread_index);
+    int CpuFor(size_t thread_index) const;
+
+    IoEngineOptions options_;
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;
+    std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work_guards_;
+
+    mutable boost::mutex threads_mutex_;
+    std::vector<std::thread> threads_;
+    std::chrono::steady_clock::time_point started_;
+};
+
+#endif // IO_ENGINE_H
@@ -0,0 +1,119 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+// One key=value pair of a structured record. Holds views only; the record is
+// formatted before Log returns.
+struct LogField {
+    LogField(std::string_view key, std::string_view value) : key(key), text(value) {}
+    LogField(std::string_view key, const std::string& value) : key(key), text(value) {}
+    LogField(std::string_view key, const char* value) : key(key), text(value) {}
+
+    template <std::integral T>
+    LogField(std::string_view key, const T value) : key(key), number(static_cast<int64_t>(value)), kind(Kind::Integer) {}
+
+    LogField(std::string_view key, const double value) : key(key), real(value), kind(Kind::Real) {}
+
+    enum class Kind : uint8_t {
+        Text,
+        Integer,
+        Real
+    };
+
+    std::string_view key;
+    std::string_view text;
+    int64_t number = 0;
+    double real = 0.0;
+    Kind kind = Kind::Text;
+};
+
+struct LoggerOptions {
+    LogLevel level = LogLevel::Info;
+    size_t capacity = 8192;
+    size_t max_records_per_second = 10000;
+    // Receives formatted lines in batches on the writer thread; stderr if empty.
+    std::function<void(std::string_view)> sink;
+};
+
+// Asynchronous logfmt logger. Callers format a record straight into a slot
+// of a bounded lock-free ring and return; one background thread stamps and
+// writes the records. A full ring or an exhausted per-second budget drops the
+// record and counts it, so logging never waits on I/O or on other threads.
+// The writer reports drop counts as records of their own.
+class Logger {
+public:
+    static constexpr size_t kMaxRecordBytes = 480;
+
+    explicit Logger(LoggerOptions options = {});
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static Logger& GetInstance();
+
+    bool Enabled(LogLevel level) const;
+    void SetLevel(LogLevel level);
+
+    void Log(LogLevel level, std::string_view message, std::initializer_list<LogField> fields = {});
+
+    // Blocks until every record logged before the call has reached the sink.
+    void Flush();
+
+    uint64_t Dropped() const;
+    uint64_t Suppressed() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        std::chrono::system_clock::time_point time;
+        uint16_t length;
+        char text[kMaxRecordBytes];
+    };
+
+    bool TryAcquireBudget();
+    bool DrainInto(std::string& batch);
+    void ReportLosses(std::string& batch);
+    void WriterLoop();
+
+    std::atomic<LogLevel> level_;
+    size_t max_records_per_second_;
+    std::function<void(std::string_view)> sink_;
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> written_pos_{0};
+    size_t dequeue_pos_ = 0;
+
+    std::atomic<int64_t> budget_window_{0};
+    std::atomic<uint64_t> budget_used_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> suppressed_{0};
+    uint64_t reported_dropped_ = 0;
+    uint64_t reported_suppressed_ = 0;
+
+    std::atomic<bool> stopping_{false};
+    std::thread writer_;
+};
+
+#endif // LOGGER_H
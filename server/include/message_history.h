@@ -0,0 +1,53 @@
+#ifndef MESSAGE_HISTORY_H
+#define MESSAGE_HISTORY_H
+
+#include "broadcast_message.h"
+#include <cstdint>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+struct HistoryLimits {
+    size_t max_messages = 1000;
+    size_t max_bytes = 1024 * 1024;
+};
+
+struct HistoryEntry {
+    uint64_t sequence;
+    BroadcastMessagePtr message;
+};
+
+using HistorySlice = std::vector<HistoryEntry>;
+
+// Fixed-capacity ring of the most recent messages of a room. Entries carry a
+// monotonically increasing sequence number so readers can page with a cursor.
+// Slices share the stored messages; only the entry handles are copied.
+class MessageHistory {
+public:
+    explicit MessageHistory(HistoryLimits limits = {});
+
+    uint64_t Append(BroadcastMessagePtr message);
+
+    HistorySlice Tail(size_t count) const;
+    HistorySlice Page(uint64_t after_sequence, size_t limit) const;
+
+    uint64_t FirstSequence() const;
+    uint64_t LastSequence() const;
+    size_t Size() const;
+    size_t Bytes() const;
+
+private:
+    void EvictOldest();
+    // The entry offset places after the oldest one.
+    const HistoryEntry& At(size_t offset) const;
+    HistorySlice Slice(size_t offset, size_t count) const;
+
+    HistoryLimits limits_;
+    mutable boost::mutex history_mutex_;
+    std::vector<HistoryEntry> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    size_t bytes_ = 0;
+    uint64_t next_sequence_ = 1;
+};
+
+#endif // MESSAGE_HISTORY_H
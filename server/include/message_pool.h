@@ -0,0 +1,23 @@
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H
+
+#include "broadcast_message.h"
+#include <string_view>
+
+// Per-thread free lists of BroadcastMessage objects. A released message keeps
+// its string capacity and goes back to the thread that acquired it: directly
+// when that thread drops the last reference, otherwise through a lock-free
+// return stack the owner drains when its free list runs dry. So in steady
+// state an inbound frame is copied into an existing buffer without touching
+// the global allocator, even though delivery threads release the messages.
+class MessagePool {
+public:
+    static constexpr size_t kMaxPooledPerThread = 1024;
+    static constexpr size_t kMaxPooledCapacity = 64 * 1024;
+
+    static BroadcastMessagePtr Acquire(std::string_view payload, WireProtocol encoding, std::string_view sender);
+    static void Recycle(BroadcastMessage* message);
+    static size_t PooledOnThisThread();
+};
+
+#endif // MESSAGE_POOL_H
@@ -0,0 +1,31 @@
+#ifndef METRICS_ENDPOINT_H
+#define METRICS_ENDPOINT_H
+
+#include "headers.h"
+#include <string>
+#include <boost/atomic.hpp>
+
+// Serves ServerMetrics and room gauges in the Prometheus text format on a
+// separate admin port. Runs on one of the server's io_contexts; every request
+// gets its own short-lived connection, and any path answers with the metrics.
+class MetricsEndpoint {
+public:
+    // Rooms beyond this many, by connection count, appear only in the totals.
+    static constexpr size_t kMaxRoomSeries = 20;
+
+    MetricsEndpoint(io_context& io_context, const ip::tcp::endpoint& endpoint);
+    ~MetricsEndpoint();
+
+    void Start();
+    void Stop();
+
+    static std::string Render();
+
+private:
+    void AsyncAccept();
+
+    ip::tcp::acceptor acceptor_;
+    boost::atomic<bool> is_accepting_{false};
+};
+
+#endif // METRICS_ENDPOINT_H
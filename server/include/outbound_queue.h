@@ -0,0 +1,48 @@
+#ifndef OUTBOUND_QUEUE_H
+#define OUTBOUND_QUEUE_H
+
+#include "broadcast_message.h"
+#include "connection_options.h"
+#include <deque>
+
+// Single-writer send queue for one connection. Messages pushed while a write
+// is in flight are collected in pending_ and handed to the writer as one batch
+// once the current batch drains. Not thread-safe; the owner serializes access.
+class OutboundQueue {
+public:
+    enum class PushResult {
+        Queued,
+        StartWrite,
+        Dropped,
+        Overflow
+    };
+
+    explicit OutboundQueue(
+        size_t max_queued_bytes = ConnectionOptions{}.max_queued_bytes,
+        OverflowPolicy overflow_policy = ConnectionOptions{}.overflow_policy
+    );
+
+    PushResult Push(BroadcastMessagePtr message);
+
+    const BroadcastMessage* Front();
+    bool PopFront();
+    void Close();
+    void Seal();
+
+    size_t QueuedBytes() const;
+    size_t QueuedMessages() const;
+    bool IsWriting() const;
+
+private:
+    bool MakeRoom(size_t payload_size);
+
+    std::deque<BroadcastMessagePtr> pending_;
+    std::deque<BroadcastMessagePtr> batch_;
+    size_t queued_bytes_ = 0;
+    size_t max_queued_bytes_;
+    OverflowPolicy overflow_policy_;
+    bool writing_ = false;
+    bool closed_ = false;
+};
+
+#endif // OUTBOUND_QUEUE_H
@@ -1,36 +1,102 @@
 #ifndef ROOM_H
 #define ROOM_H
 
+#include <limits>
 #include <vector>
 #include <string>
 #include <boost/asio.hpp>
+#include <boost/atomic.hpp>
 #include <boost/smart_ptr.hpp>
+#include <boost/smart_ptr/atomic_shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
+#include "broadcast_message.h"
+#include "broadcast_batcher.h"
+#include "delivery_executor.h"
+#include "message_history.h"
+#include "room_options.h"
 
 class SocketConnection;
 
+// Members live in a dense vector so broadcasts walk contiguous memory. Each
+// member gets a stable handle that maps to its current position; removal by
+// handle swaps the last member into the hole, so joins and leaves are O(1).
+// Members whose connection died without leaving are swept lazily on growth.
+// A handle carries its slot's generation, so removing by a handle whose
+// member was already swept cannot evict whoever reuses the slot.
+//
+// Readers never see that vector. Membership changes invalidate an immutable
+// snapshot of the member list, which the next reader rebuilds once; from then
+// on broadcasts and user-list queries load it without taking room_mutex_, and
+// a broadcast hands the same snapshot to its delivery task.
+//
+// Inbound limits apply to everything the members send together; members pay
+// for the room's debt by pausing their own reads. With a batch window set,
+// deliveries go through a BroadcastBatcher; history still records every
+// message on its own.
 class Room {
 public:
-    explicit Room(std::string room_name);
+    // Slot in the low 32 bits, the slot's generation in the high 32 bits.
+    using MemberHandle = uint64_t;
+    static constexpr MemberHandle kNoMember = std::numeric_limits<MemberHandle>::max();
 
-    void AddConnection(boost::weak_ptr<SocketConnection> connection);
+    explicit Room(std::string room_name, RoomOptions options = {});
+
+    MemberHandle AddConnection(boost::weak_ptr<SocketConnection> connection);
+    void RemoveConnection(MemberHandle handle);
     void RemoveConnection(const boost::weak_ptr<SocketConnection> &connection);
     void DistributeMessage(const std::string& content);
+    void DistributeMessage(const BroadcastMessagePtr& message);
+    void RestoreHistory(const std::vector<BroadcastMessagePtr>& messages);
+
+    // Counts one inbound message against the room's limits and returns how
+    // long its sender should wait before reading the next one.
+    TokenBucket::Clock::duration ChargeInbound(size_t bytes, TokenBucket::Clock::time_point now);
 
     std::vector<std::string> GetMessageHistory() const;
+    HistorySlice GetRecentHistory(size_t count) const;
+    HistorySlice GetHistoryPage(uint64_t after_sequence, size_t limit) const;
     std::vector<std::string> GetActiveUsers() const;
+    const std::string& GetName() const;
+    size_t ConnectionCount() const;
+    uint64_t MessagesDistributed() const;
 
 private:
+    struct Member {
+        boost::weak_ptr<SocketConnection> connection;
+        uint32_t slot;
+    };
+
+    struct Slot {
+        uint32_t position;
+        uint32_t generation;
+    };
+
+    using MemberList = std::vector<boost::weak_ptr<SocketConnection>>;
+
+    boost::shared_ptr<const MemberList> MemberSnapshot() const;
+    void EraseMemberAt(size_t position);
+    void CompactExpiredMembers();
+    void UnregisterIfEmpty() const;
+
     static void ProcessMessageDelivery(
-        const std::string& formatted_message,
+        const BroadcastMessagePtr& message,
         const boost::weak_ptr<SocketConnection> &connection
     );
 
     mutable boost::mutex room_mutex_;
-    std::vector<boost::weak_ptr<SocketConnection>> connections_;
-    std::vector<std::string> message_history_;
+    std::vector<Member> members_;
+    std::vector<Slot> member_slots_;
+    std::vector<uint32_t> free_slots_;
+    size_t compact_threshold_;
+    mutable boost::atomic_shared_ptr<const MemberList> member_snapshot_;
+    boost::mutex distribute_mutex_;
+    boost::atomic<uint64_t> messages_distributed_{0};
+    MessageHistory message_history_;
     std::string room_identifier_;
-    boost::asio::thread_pool delivery_pool_{4};
+    DeliveryExecutor::Shard delivery_shard_;
+    TokenBucket inbound_messages_;
+    TokenBucket inbound_bytes_;
+    boost::shared_ptr<BroadcastBatcher> batcher_;
 };
 
 #endif // ROOM_H
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef ROOM_OPTIONS_H
+#define ROOM_OPTIONS_H
+
+#include "message_history.h"
+#include "token_bucket.h"
+#include <chrono>
+#include <cstddef>
+
+// Broadcasts arriving within window of the first pending one go out as one
+// frame, sooner if the batch reaches max_bytes or max_messages. A zero
+// window turns batching off.
+struct BatchOptions {
+    std::chrono::microseconds window{0};
+    size_t max_bytes = 64 * 1024;
+    size_t max_messages = 256;
+};
+
+struct RoomOptions {
+    HistoryLimits history;
+    // What all members together may send.
+    InboundLimits inbound;
+    BatchOptions batch;
+};
+
+#endif // ROOM_OPTIONS_H
@@ -1,23 +1,62 @@
 #ifndef ROOMSSINGLETON_H
 #define ROOMSSINGLETON_H
 
+#include <array>
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <boost/atomic.hpp>
 #include <boost/smart_ptr.hpp>
+#include <boost/smart_ptr/atomic_shared_ptr.hpp>
 #include <boost/thread.hpp>
 #include "room.h"
+#include "broadcast_message.h"
 
+class SocketConnection;
+
+struct RoomListSnapshot {
+    uint64_t version;
+    BroadcastMessagePtr payload;
+};
+
+// Room registry split into shards. Each shard publishes an immutable map
+// snapshot: lookups and listings load the current snapshot without taking a
+// lock, and writers serialize per shard to copy, modify and swap it in.
+//
+// The serialized room list is cached per registry version and shared by every
+// new connection. Connections waiting in the lobby subscribe to a change feed
+// and receive "roomAdded"/"roomRemoved" deltas tagged with the version that
+// produced them. The subscribers are an immutable snapshot too, so a change
+// is fanned out without holding up connections entering or leaving the lobby.
 class RoomsSingleton {
-    static boost::shared_ptr<RoomsSingleton> instance_;
-    static boost::mutex instance_mutex_;
+    using RoomMap = std::unordered_map<std::string, boost::shared_ptr<Room>>;
+    using LobbyMap = std::unordered_map<const SocketConnection*, boost::weak_ptr<SocketConnection>>;
+
+    struct alignas(64) Shard {
+        boost::atomic_shared_ptr<const RoomMap> rooms{boost::make_shared<const RoomMap>()};
+        boost::mutex write_mutex;
+    };
+
+    static constexpr size_t kShardCount = 64;
 
-    std::unordered_map<std::string, boost::shared_ptr<Room>> rooms_;
-    mutable boost::shared_mutex rooms_mutex_;
+    std::array<Shard, kShardCount> shards_;
+    boost::atomic<size_t> room_count_{0};
+
+    boost::atomic<uint64_t> version_{0};
+    boost::atomic_shared_ptr<const RoomListSnapshot> room_list_;
+    boost::mutex room_list_mutex_;
+
+    boost::atomic_shared_ptr<const LobbyMap> lobby_{boost::make_shared<const LobbyMap>()};
+    boost::mutex lobby_mutex_;
+    // Orders version bumps with the posting of their deltas.
+    boost::mutex publish_mutex_;
 
     explicit RoomsSingleton() = default;
 
     static void ValidateName(const std::string& name);
+    void PublishChange(bool added, const std::string& name);
+    Shard& ShardFor(const std::string& name);
+    const Shard& ShardFor(const std::string& name) const;
 
 public:
     RoomsSingleton(const RoomsSingleton&) = delete;
@@ -30,6 +69,14 @@ public:
     boost::shared_ptr<Room> FetchRoom(const std::string& name) const;
 
     std::vector<std::string> GetAllRoomNames() const;
+    std::vector<boost::shared_ptr<Room>> GetAllRooms() const;
+    size_t RoomCount() const;
+
+    uint64_t Version() const;
+    RoomListSnapshot GetRoomListSnapshot();
+    void SubscribeLobby(const boost::shared_ptr<SocketConnection>& connection);
+    void UnsubscribeLobby(const SocketConnection* connection);
+
     void PurgeAllRooms();
 };
 
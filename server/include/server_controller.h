@@ -3,35 +3,39 @@
 
 #include <boost/asio.hpp>
 #include <boost/atomic.hpp>
+#include <boost/smart_ptr.hpp>
+#include <memory>
+#include <vector>
+#include "server_options.h"
 
 using boost::system::error_code;
 using boost::asio::io_context;
 
+class ConnectionAcceptor;
+class MetricsEndpoint;
+class HistoryLog;
+class IoEngine;
+
 class ServerController {
 public:
     static int RunService(int argc, char** argv);
 
-    static boost::atomic<bool> g_force_exit;
-
 private:
-    static bool ValidateArguments(int arg_count, char** arg_values);
-    static void InitializeNetworkComponents(
+    static bool ParseArguments(int arg_count, char** arg_values, ServerOptions& options);
+    static void PrintUsage(const char* program);
+    static boost::shared_ptr<ConnectionAcceptor> InitializeNetworkComponents(
         io_context& ctx,
-        const char* port,
-        size_t thread_count = 4
+        const ServerOptions& options
     );
-    static void SetupSignalHandling();
-
-    class ThreadPoolWrapper {
-    public:
-        void WaitForCompletion();
-        explicit ThreadPoolWrapper(size_t threads);
-        void Submit(io_context& ctx);
-        ~ThreadPoolWrapper();
-        
-    private:
-        boost::asio::thread_pool pool_;
-    };
+    static boost::shared_ptr<MetricsEndpoint> InitializeMetricsEndpoint(io_context& ctx, const ServerOptions& options);
+    static std::unique_ptr<HistoryLog> InitializeHistoryLog(const ServerOptions& options);
+    static void RunEngine(const ServerOptions& options);
+    static void AwaitShutdown(
+        const std::vector<boost::shared_ptr<ConnectionAcceptor>>& listeners,
+        const ShutdownOptions& options
+    );
+    static void PrintThreadUsage(const IoEngine& engine);
+    static void PrintAllocatorStats();
 };
 
-#endif // SERVER_CONTROLLER_H
\ No newline at end of file
+#endif // SERVER_CONTROLLER_H
@@ -0,0 +1,83 @@
+#ifndef SERVER_METRICS_H
+#define SERVER_METRICS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+enum class Metric : size_t {
+    Accepts,
+    Handshakes,
+    MessagesIn,
+    MessagesOut,
+    BytesIn,
+    BytesOut,
+    DroppedSends,
+    HeartbeatFailures,
+    ReadPauses,
+    OpenConnections,
+    QueuedMessages,
+    QueuedBytes,
+    Count
+};
+
+enum class LatencyMetric : size_t {
+    AcceptToHandshake,
+    ReceiveToFanout,
+    Count
+};
+
+// Process-wide counters and latency histograms. Every thread updates its own
+// slots with relaxed stores and no read-modify-write, so an update costs a
+// thread-local lookup and a plain add. Collect sums all live threads and the
+// totals left behind by threads that exited.
+//
+// Gauges (open connections, queue depths) are kept as signed deltas: a value
+// may go up on one thread and down on another, and only the sum is exported.
+class ServerMetrics {
+public:
+    static constexpr size_t kMetricCount = static_cast<size_t>(Metric::Count);
+    static constexpr size_t kLatencyMetricCount = static_cast<size_t>(LatencyMetric::Count);
+
+    // Upper bounds of the histogram buckets; one more bucket catches the rest.
+    static constexpr std::array<std::chrono::microseconds, 15> kBucketBounds{
+        std::chrono::microseconds(50),
+        std::chrono::microseconds(100),
+        std::chrono::microseconds(250),
+        std::chrono::microseconds(500),
+        std::chrono::microseconds(1000),
+        std::chrono::microseconds(2500),
+        std::chrono::microseconds(5000),
+        std::chrono::microseconds(10000),
+        std::chrono::microseconds(25000),
+        std::chrono::microseconds(50000),
+        std::chrono::microseconds(100000),
+        std::chrono::microseconds(250000),
+        std::chrono::microseconds(500000),
+        std::chrono::microseconds(1000000),
+        std::chrono::microseconds(2500000)
+    };
+    static constexpr size_t kBucketCount = kBucketBounds.size() + 1;
+
+    struct Histogram {
+        std::array<uint64_t, kBucketCount> buckets{};
+        std::chrono::nanoseconds sum{0};
+
+        uint64_t Count() const;
+    };
+
+    struct Snapshot {
+        std::array<int64_t, kMetricCount> values{};
+        std::array<Histogram, kLatencyMetricCount> latencies{};
+
+        int64_t Get(Metric metric) const;
+        const Histogram& Get(LatencyMetric metric) const;
+    };
+
+    static void Add(Metric metric, int64_t delta = 1);
+    static void Observe(LatencyMetric metric, std::chrono::steady_clock::duration latency);
+    static Snapshot Collect();
+};
+
+#endif // SERVER_METRICS_H
@@ -0,0 +1,43 @@
+#ifndef SERVER_OPTIONS_H
+#define SERVER_OPTIONS_H
+
+#include "logger.h"
+#include "connection_options.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+enum class IoMode {
+    Shared,
+    PerCore
+};
+
+struct IoEngineOptions {
+    size_t threads = 4;
+    IoMode mode = IoMode::Shared;
+    bool pin_cpus = false;
+};
+
+struct ShutdownOptions {
+    // Connections still open after this long are dropped.
+    std::chrono::milliseconds drain_timeout{10000};
+    // Close frames go out this many at a time, spreading reconnects.
+    size_t close_batch = 256;
+    std::chrono::milliseconds close_interval{10};
+};
+
+struct ServerOptions {
+    std::string port;
+    IoEngineOptions io;
+    std::string admin_port;
+    // Metrics are not authenticated, so they stay on loopback unless asked.
+    std::string admin_address = "127.0.0.1";
+    LogLevel log_level = LogLevel::Info;
+    DeflateOptions deflate;
+    InboundLimits connection_limits;
+    RoomOptions room;
+    std::string history_dir;
+    ShutdownOptions shutdown;
+};
+
+#endif // SERVER_OPTIONS_H
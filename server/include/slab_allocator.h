@@ -0,0 +1,75 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+// Per-thread free lists of fixed-size blocks in power-of-two size classes.
+// A freed block goes back to the thread that allocated it: directly when that
+// thread frees it, otherwise through a lock-free return stack the owner drains
+// when a list runs dry. So under steady connection churn accepts, handlers and
+// read buffers are served without the global allocator, and blocks freed on
+// delivery threads do not pile up there. Requests above kMaxBlock fall through
+// to operator new.
+//
+// Built with SERVER_POOLED_ALLOCATOR; without it every call goes straight to
+// operator new and the statistics stay at zero.
+class SlabAllocator {
+public:
+    static constexpr size_t kMinBlock = 32;
+    static constexpr size_t kSizeClasses = 8;
+    static constexpr size_t kMaxBlock = kMinBlock << (kSizeClasses - 1);
+    static constexpr size_t kMaxCachedPerClass = 1024;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t oversized = 0;
+        // Made by threads whose slab was already torn down.
+        uint64_t after_teardown = 0;
+
+        double HitRate() const;
+    };
+
+    static void* Allocate(size_t bytes);
+    static void Deallocate(void* block, size_t bytes) noexcept;
+
+    static bool Enabled();
+    static Stats GetStats();
+};
+
+template <typename T>
+class PooledAllocator {
+public:
+    using value_type = T;
+
+    PooledAllocator() noexcept = default;
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) noexcept {}
+
+    T* allocate(const size_t count) {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return std::allocator<T>().allocate(count);
+        } else {
+            return static_cast<T*>(SlabAllocator::Allocate(count * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* pointer, const size_t count) noexcept {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            std::allocator<T>().deallocate(pointer, count);
+        } else {
+            SlabAllocator::Deallocate(pointer, count * sizeof(T));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+#endif // SLAB_ALLOCATOR_H
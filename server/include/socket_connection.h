@@ -4,36 +4,80 @@
 #include "headers.h"
 #include "room.h"
 #include "room_command.h"
+#include "connection_options.h"
+#include "outbound_queue.h"
+#include "heartbeat_manager.h"
+#include "wire_codec.h"
+#include "slab_allocator.h"
+#include "logger.h"
 #include <boost/smart_ptr.hpp>
-#include <boost/asio/steady_timer.hpp>
 
 using json = nlohmann::json;
 
+// All stream, timer and queue state is touched only from the executor of the
+// accepted socket, which the acceptor makes a per-connection strand. Calls that
+// may come from other threads (TransmitData, InitializeWebsocket) hop onto it.
 class SocketConnection : public boost::enable_shared_from_this<SocketConnection> {
 public:
-    explicit SocketConnection(ip::tcp::socket&& socket);
+    explicit SocketConnection(ip::tcp::socket&& socket, ConnectionOptions options = {});
     ~SocketConnection();
 
     void InitializeWebsocket();
     void TransmitData(const std::string& payload);
+    void TransmitData(const BroadcastMessagePtr& message);
     void ProcessClientCommand(const RoomCommand& cmd);
+    void BeginShutdown();
     std::string GetUserIdentifier() const;
+    any_io_executor GetExecutor();
+    WireProtocol GetWireProtocol() const;
+    void HandleHeartbeatDue();
 
 private:
     websocket::stream<tcp_stream> websocket_stream_;
-    flat_buffer data_buffer_;
+    basic_flat_buffer<PooledAllocator<char>> data_buffer_;
+    http::request<http::string_body> handshake_request_;
+    WireProtocol wire_protocol_ = WireProtocol::Json;
     boost::shared_ptr<Room> associated_room_;
+    Room::MemberHandle room_member_ = Room::kNoMember;
     std::string user_identity_;
-    steady_timer heartbeat_timer_;
-    std::atomic<bool> pong_received_{true};
+    HeartbeatManager::Handle heartbeat_handle_;
+    std::chrono::steady_clock::time_point last_activity_;
+    std::chrono::steady_clock::time_point accepted_at_;
+    bool ping_outstanding_ = false;
+    bool heartbeat_stopped_ = false;
+    bool handshake_complete_ = false;
+    bool draining_ = false;
+    bool close_sent_ = false;
+    bool reads_paused_ = false;
+    ConnectionOptions options_;
+    uint64_t connection_id_;
+    OutboundQueue send_queue_;
+    size_t reported_queued_messages_ = 0;
+    size_t reported_queued_bytes_ = 0;
+    TokenBucket inbound_messages_;
+    TokenBucket inbound_bytes_;
+    boost::asio::steady_timer read_resume_timer_;
 
     void TerminateConnection(const std::string& reason, websocket::close_code close_code);
+    void CloseAfterDrain();
+    void AcceptWebsocket();
+    bool DecodeClientCommand(RoomCommand& cmd) const;
     void ProcessInitialHandshake();
     void UpdateRoomListing();
     void ConfigureHeartbeat();
+    void ScheduleHeartbeat(std::chrono::steady_clock::duration delay);
+    void StopHeartbeat();
+    void MarkActivity();
     void PrepareSessionData();
     void MaintainConnection();
     void ReadNextMessage();
+    std::chrono::steady_clock::duration ChargeInbound(size_t bytes);
+    void ResumeReading(std::chrono::steady_clock::duration delay);
+    void EnqueueMessage(const BroadcastMessagePtr& message);
+    void WriteNextMessage();
+    void HandleWriteCompletion(const error_code& ec, std::size_t bytes_transferred);
+    void ReportQueueDepth();
+    void LogEvent(LogLevel level, std::string_view message, std::string_view detail = {}) const;
 };
 
 #endif // SOCKET_CONNECTION_H
\ No newline at end of file
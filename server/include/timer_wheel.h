@@ -0,0 +1,53 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Hashed timing wheel. Timers live in an index-linked node pool, so Schedule
+// and Cancel are O(1) and never search; Advance visits a single slot. Timers
+// longer than one revolution carry a round counter. Not thread-safe.
+class TimerWheel {
+public:
+    struct Handle {
+        uint32_t index = std::numeric_limits<uint32_t>::max();
+        uint32_t generation = 0;
+
+        bool Valid() const { return index != std::numeric_limits<uint32_t>::max(); }
+    };
+
+    explicit TimerWheel(size_t slot_count);
+
+    Handle Schedule(uint64_t ticks, uint64_t payload);
+    bool Cancel(Handle handle, uint64_t* payload = nullptr);
+    void Advance(std::vector<uint64_t>& expired);
+
+    size_t Size() const;
+    size_t SlotCount() const;
+
+private:
+    static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+
+    struct Node {
+        uint64_t payload = 0;
+        uint64_t rounds = 0;
+        uint32_t slot = 0;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        uint32_t generation = 0;
+        bool active = false;
+    };
+
+    void Unlink(uint32_t index);
+    void Release(uint32_t index);
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+    std::vector<uint32_t> slots_;
+    size_t cursor_ = 0;
+    size_t size_ = 0;
+};
+
+#endif // TIMER_WHEEL_H
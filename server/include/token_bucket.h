@@ -0,0 +1,45 @@
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// A rate of zero means no limit. Burst is how many tokens may be spent at
+// once after a quiet period; zero means one second's worth.
+struct RateLimit {
+    double per_second = 0.0;
+    double burst = 0.0;
+};
+
+struct InboundLimits {
+    RateLimit messages;
+    RateLimit bytes;
+};
+
+// Token bucket kept as the single instant at which it will be full again
+// (the GCRA form), so a charge is one compare-exchange loop and any thread
+// may charge the same bucket without a lock.
+//
+// Charge never refuses. The cost is always taken, going into debt when the
+// bucket is short, and the result is how long the caller has to wait before
+// its next charge to stay within the rate.
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TokenBucket(RateLimit limit = {});
+
+    TokenBucket(const TokenBucket&) = delete;
+    TokenBucket& operator=(const TokenBucket&) = delete;
+
+    bool Limited() const;
+    Clock::duration Charge(double cost, Clock::time_point now = Clock::now());
+
+private:
+    double ns_per_token_;
+    int64_t burst_ns_;
+    std::atomic<int64_t> full_at_{0};
+};
+
+#endif // TOKEN_BUCKET_H
@@ -0,0 +1,65 @@
+#ifndef WIRE_CODEC_H
+#define WIRE_CODEC_H
+
+#include "room_command.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class WireProtocol {
+    Json,
+    Binary
+};
+
+// Compact binary framing offered as the "chat.binary.v1" WebSocket
+// subprotocol. Every frame starts with a one-byte type, followed by
+// little-endian fixed-width integers and length-prefixed strings (u16 for
+// names, u32 for message bodies). Decoders return views into the input
+// buffer and never copy.
+class WireCodec {
+public:
+    static constexpr std::string_view kJsonSubprotocol = "chat.json";
+    static constexpr std::string_view kBinarySubprotocol = "chat.binary.v1";
+
+    enum class FrameType : uint8_t {
+        RoomCommand = 1,
+        RoomMessage = 2,
+        RoomList = 3,
+        RoomListDelta = 4,
+        RoomMessageBatch = 5
+    };
+
+    struct RoomCommandView {
+        std::string_view operation;
+        std::string_view roomName;
+        std::string_view userName;
+
+        RoomCommand ToCommand() const;
+    };
+
+    struct RoomMessageView {
+        std::string_view username;
+        std::string_view message;
+    };
+
+    static std::string EncodeRoomCommand(const RoomCommand& command);
+    static bool DecodeRoomCommand(std::string_view frame, RoomCommandView& command);
+
+    static std::string EncodeRoomMessage(std::string_view username, std::string_view message);
+    static bool DecodeRoomMessage(std::string_view frame, RoomMessageView& message);
+
+    // A batch carries whole RoomMessage frames, each prefixed by its u32 length.
+    static std::string EncodeRoomMessageBatch(const std::vector<std::string_view>& frames);
+    static bool DecodeRoomMessageBatch(std::string_view frame, std::vector<std::string_view>& frames);
+
+    static std::string EncodeRoomList(uint64_t version, const std::vector<std::string>& names);
+    static std::string EncodeRoomListDelta(bool added, uint64_t version, std::string_view name);
+
+    // Whether the comma-separated Sec-WebSocket-Protocol list names subprotocol
+    // as a whole token.
+    static bool Offers(std::string_view offered_subprotocols, std::string_view subprotocol);
+    static WireProtocol SelectProtocol(std::string_view offered_subprotocols);
+};
+
+#endif // WIRE_CODEC_H
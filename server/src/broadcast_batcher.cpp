@@ -0,0 +1,68 @@
+#include "../include/broadcast_batcher.h"
+#include "../include/socket_connection.h"
+#include "../include/server_metrics.h"
+#include <boost/thread/lock_guard.hpp>
+#include <utility>
+
+BroadcastBatcher::BroadcastBatcher(DeliveryExecutor::Shard shard, const BatchOptions options)
+    : shard_(std::move(shard)),
+      options_(options),
+      timer_(shard_) {}
+
+void BroadcastBatcher::Add(BroadcastMessagePtr message, boost::shared_ptr<const MemberList> members) {
+    boost::lock_guard guard(mutex_);
+    pending_bytes_ += message->Size();
+    pending_.push_back(std::move(message));
+    members_ = std::move(members);
+
+    if (pending_bytes_ >= options_.max_bytes || pending_.size() >= options_.max_messages) {
+        FlushLocked();
+        return;
+    }
+
+    if (pending_.size() == 1) {
+        // A wait left over from a batch the size cap already flushed finds
+        // the generation moved on and does nothing.
+        timer_.expires_after(options_.window);
+        timer_.async_wait([weak = weak_from_this(), generation = generation_](const error_code& ec) {
+            if (ec) return;
+            if (const auto self = weak.lock()) {
+                boost::lock_guard timer_guard(self->mutex_);
+                if (self->generation_ == generation) {
+                    self->FlushLocked();
+                }
+            }
+        });
+    }
+}
+
+void BroadcastBatcher::Flush() {
+    boost::lock_guard guard(mutex_);
+    FlushLocked();
+}
+
+void BroadcastBatcher::FlushLocked() {
+    if (pending_.empty()) return;
+    ++generation_;
+
+    // The batch frame is built on the shard, off the publishers' path.
+    post(
+        shard_,
+        [messages = std::exchange(pending_, {}), members = std::move(members_)] {
+            const auto batch = messages.size() == 1 ? messages.front() : MakeBatchMessage(messages);
+            for (const auto& connection : *members) {
+                if (const auto conn = connection.lock()) {
+                    conn->TransmitData(batch);
+                }
+            }
+
+            const auto fanned_out = std::chrono::steady_clock::now();
+            for (const auto& message : messages) {
+                if (const auto received_at = message->ReceivedAt(); received_at != std::chrono::steady_clock::time_point{}) {
+                    ServerMetrics::Observe(LatencyMetric::ReceiveToFanout, fanned_out - received_at);
+                }
+            }
+        }
+    );
+    pending_bytes_ = 0;
+}
@@ -0,0 +1,162 @@
+#include "../include/broadcast_message.h"
+#include "../include/message_pool.h"
+#include "../include/room_message.h"
+#include <boost/thread/lock_guard.hpp>
+
+BroadcastMessage::BroadcastMessage(std::string payload, const WireProtocol encoding, std::string sender)
+    : payload_(std::move(payload)),
+      encoding_(encoding),
+      sender_(std::move(sender)) {}
+
+BroadcastMessage::BroadcastMessage(std::string json_payload, std::string binary_payload)
+    : payload_(std::move(json_payload)),
+      encoding_(WireProtocol::Json),
+      transcoded_ready_(true),
+      transcoded_(std::move(binary_payload)) {}
+
+BroadcastMessage::BroadcastMessage(std::vector<BroadcastMessagePtr> parts)
+    : encoding_(WireProtocol::Json),
+      parts_(std::move(parts)),
+      payload_ready_(false) {
+    // What a JSON array of the parts takes when none of them needs quoting.
+    batch_size_ = parts_.size() + 1;
+    for (const auto& part : parts_) {
+        batch_size_ += part->Size();
+    }
+}
+
+const std::string& BroadcastMessage::Data() const {
+    if (payload_ready_.load(std::memory_order_acquire)) {
+        return payload_;
+    }
+
+    boost::lock_guard guard(transcode_mutex_);
+    if (!payload_ready_.load(std::memory_order_relaxed)) {
+        payload_ = EncodeBatch(encoding_);
+        payload_ready_.store(true, std::memory_order_release);
+    }
+    return payload_;
+}
+
+boost::asio::const_buffer BroadcastMessage::Buffer() const {
+    return boost::asio::buffer(Data());
+}
+
+boost::asio::const_buffer BroadcastMessage::BufferFor(const WireProtocol protocol) const {
+    return protocol == encoding_ ? Buffer() : boost::asio::buffer(Transcoded());
+}
+
+size_t BroadcastMessage::Size() const {
+    return parts_.empty() ? payload_.size() : batch_size_;
+}
+
+WireProtocol BroadcastMessage::Encoding() const {
+    return encoding_;
+}
+
+const std::string& BroadcastMessage::Sender() const {
+    return sender_;
+}
+
+uint32_t BroadcastMessage::UseCount() const {
+    return ref_count_.load(std::memory_order_relaxed);
+}
+
+std::chrono::steady_clock::time_point BroadcastMessage::ReceivedAt() const {
+    return received_at_;
+}
+
+void BroadcastMessage::Assign(const std::string_view payload, const WireProtocol encoding, const std::string_view sender) {
+    // assign() keeps the existing capacity, so a recycled message only
+    // allocates when the new frame is larger than anything it held before.
+    payload_.assign(payload);
+    encoding_ = encoding;
+    sender_.assign(sender);
+    received_at_ = std::chrono::steady_clock::now();
+    transcoded_.clear();
+    transcoded_ready_.store(false, std::memory_order_relaxed);
+}
+
+size_t BroadcastMessage::RetainedCapacity() const {
+    return payload_.capacity() + sender_.capacity() + transcoded_.capacity();
+}
+
+const std::string& BroadcastMessage::Transcoded() const {
+    if (transcoded_ready_.load(std::memory_order_acquire)) {
+        return transcoded_;
+    }
+
+    boost::lock_guard guard(transcode_mutex_);
+    if (!transcoded_ready_.load(std::memory_order_relaxed)) {
+        if (!parts_.empty()) {
+            transcoded_ = EncodeBatch(WireProtocol::Binary);
+        } else if (encoding_ == WireProtocol::Json) {
+            transcoded_ = WireCodec::EncodeRoomMessage(sender_, payload_);
+        } else if (WireCodec::RoomMessageView view; WireCodec::DecodeRoomMessage(payload_, view)) {
+            const RoomMessage message{std::string(view.username), std::string(view.message)};
+            transcoded_ = nlohmann::json(message).dump();
+        }
+        transcoded_ready_.store(true, std::memory_order_release);
+    }
+    return transcoded_;
+}
+
+std::string BroadcastMessage::EncodeBatch(const WireProtocol protocol) const {
+    if (protocol == WireProtocol::Binary) {
+        std::vector<std::string_view> frames;
+        frames.reserve(parts_.size());
+        for (const auto& part : parts_) {
+            const auto binary = part->BufferFor(WireProtocol::Binary);
+            frames.emplace_back(static_cast<const char*>(binary.data()), binary.size());
+        }
+        return WireCodec::EncodeRoomMessageBatch(frames);
+    }
+
+    // Relayed text need not be JSON, so anything that does not parse goes in
+    // as a string; the array stays well formed either way.
+    std::string batch = "[";
+    for (const auto& part : parts_) {
+        if (batch.size() > 1) batch += ',';
+        const auto buffer = part->BufferFor(WireProtocol::Json);
+        const std::string_view json(static_cast<const char*>(buffer.data()), buffer.size());
+        if (nlohmann::json::accept(json)) {
+            batch += json;
+        } else {
+            batch += nlohmann::json(json).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+        }
+    }
+    batch += ']';
+    return batch;
+}
+
+void intrusive_ptr_add_ref(const BroadcastMessage* message) {
+    message->ref_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void intrusive_ptr_release(const BroadcastMessage* message) {
+    if (message->ref_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    if (message->pool_) {
+        MessagePool::Recycle(const_cast<BroadcastMessage*>(message));
+    } else {
+        delete message;
+    }
+}
+
+BroadcastMessagePtr MakeBroadcastMessage(std::string payload) {
+    return BroadcastMessagePtr(new BroadcastMessage(std::move(payload)));
+}
+
+BroadcastMessagePtr MakeBroadcastMessage(std::string payload, const WireProtocol encoding, std::string sender) {
+    return BroadcastMessagePtr(new BroadcastMessage(std::move(payload), encoding, std::move(sender)));
+}
+
+BroadcastMessagePtr MakeDualEncodedMessage(std::string json_payload, std::string binary_payload) {
+    return BroadcastMessagePtr(new BroadcastMessage(std::move(json_payload), std::move(binary_payload)));
+}
+
+BroadcastMessagePtr MakeBatchMessage(const std::vector<BroadcastMessagePtr>& messages) {
+    return BroadcastMessagePtr(new BroadcastMessage(messages));
+}
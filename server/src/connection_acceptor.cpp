@@ -1,16 +1,26 @@
 #include "../include/connection_acceptor.h"
 #include "../include/socket_connection.h"
+#include "../include/slab_allocator.h"
+#include "../include/server_metrics.h"
+#include "../include/connection_registry.h"
+
+namespace {
+#ifdef SO_REUSEPORT
+    using reuse_port_option = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+}
 
 ConnectionAcceptor::ConnectionAcceptor(
     io_context& io_context,
     const ip::tcp::endpoint& endpoint,
-    const size_t thread_pool_size
+    const bool reuse_port,
+    ConnectionOptions connection_options
 ) :
     io_context_(io_context),
     acceptor_(io_context),
-    thread_pool_size_(thread_pool_size)
+    connection_options_(std::move(connection_options))
 {
-    InitAcceptor();
+    InitAcceptor(reuse_port);
     acceptor_.bind(endpoint);
     acceptor_.listen();
 }
@@ -22,38 +32,57 @@ ConnectionAcceptor::~ConnectionAcceptor() {
 void ConnectionAcceptor::Start() {
     is_accepting_ = true;
     AsyncAccept();
+}
 
-    for(size_t i = 0; i < thread_pool_size_; ++i) {
-        worker_threads_.emplace_back(&ConnectionAcceptor::WorkerThread, this);
-    }
+void ConnectionAcceptor::StopAccepting() {
+    // Runs on the acceptor's io_context; its threads keep serving the
+    // connections already accepted.
+    is_accepting_ = false;
+    error_code ignored;
+    acceptor_.close(ignored);
 }
 
 void ConnectionAcceptor::Stop() {
-    is_accepting_ = false;
-    acceptor_.close();
+    StopAccepting();
+}
 
-    for(auto& thread : worker_threads_) {
-        if(thread.joinable()) {
-            thread.join();
-        }
-    }
+io_context& ConnectionAcceptor::GetContext() const {
+    return io_context_;
 }
 
-void ConnectionAcceptor::InitAcceptor() {
+void ConnectionAcceptor::InitAcceptor(const bool reuse_port) {
     acceptor_.open(ip::tcp::v4());
     acceptor_.set_option(ip::tcp::acceptor::reuse_address(true));
+
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        // Every acceptor binds the same port; the kernel spreads incoming
+        // connections across them.
+        acceptor_.set_option(reuse_port_option(true));
+#else
+        throw std::runtime_error("SO_REUSEPORT is not supported on this platform");
+#endif
+    }
 }
 
 void ConnectionAcceptor::AsyncAccept() {
     if(!is_accepting_) return;
 
-    auto socket = boost::make_shared<ip::tcp::socket>(io_context_);
+    // Each connection gets its own strand; its handlers never run concurrently
+    // even when several threads run the io_context.
+    auto socket = boost::allocate_shared<ip::tcp::socket>(
+        PooledAllocator<ip::tcp::socket>(),
+        make_strand(io_context_)
+    );
 
     acceptor_.async_accept(
         *socket,
-        [this, socket](const boost::system::error_code& error) {
-            HandleAccept(socket, error);
-        }
+        bind_allocator(
+            PooledAllocator<void>(),
+            [this, socket](const boost::system::error_code& error) {
+                HandleAccept(socket, error);
+            }
+        )
     );
 }
 
@@ -62,7 +91,13 @@ void ConnectionAcceptor::HandleAccept(
     const boost::system::error_code& error
 ) {
     if(!error) {
-        const auto connection = boost::make_shared<SocketConnection>(std::move(*socket));
+        ServerMetrics::Add(Metric::Accepts);
+        const auto connection = boost::allocate_shared<SocketConnection>(
+            PooledAllocator<SocketConnection>(),
+            std::move(*socket),
+            connection_options_
+        );
+        ConnectionRegistry::GetInstance().Register(connection);
         ProcessConnection(connection);
     }
 
@@ -73,20 +108,9 @@ void ConnectionAcceptor::HandleAccept(
 
 void ConnectionAcceptor::ProcessConnection(const boost::shared_ptr<SocketConnection>& connection) const {
     post(
-        io_context_,
+        connection->GetExecutor(),
         [connection] {
             connection->InitializeWebsocket();
         }
     );
 }
-
-void ConnectionAcceptor::WorkerThread() const {
-    while(is_accepting_) {
-        try {
-            io_context_.run();
-        }
-        catch(const std::exception& e) {
-            std::cerr << "Worker thread exception: " << e.what() << std::endl;
-        }
-    }
-}
@@ -0,0 +1,51 @@
+#include "../include/connection_registry.h"
+#include <cstdint>
+#include <boost/thread/lock_guard.hpp>
+
+ConnectionRegistry& ConnectionRegistry::GetInstance() {
+    // Leaked: ~SocketConnection unregisters, and the last reference to a
+    // connection can sit in a delivery task that is destroyed at exit.
+    static auto* instance = new ConnectionRegistry();
+    return *instance;
+}
+
+ConnectionRegistry::Shard& ConnectionRegistry::ShardFor(const SocketConnection* connection) {
+    // std::hash of a pointer is the address itself, and connections are
+    // allocated on 16-byte boundaries, so its low bits would pick shard 0 for
+    // every one of them. Multiplying spreads the address into the high bits.
+    const uint64_t mixed = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(connection)) * 0x9e3779b97f4a7c15ull;
+    return shards_[(mixed >> 32) % kShardCount];
+}
+
+void ConnectionRegistry::Register(const boost::shared_ptr<SocketConnection>& connection) {
+    auto& shard = ShardFor(connection.get());
+    boost::lock_guard guard(shard.mutex);
+    if (shard.connections.emplace(connection.get(), connection).second) {
+        ++size_;
+    }
+}
+
+void ConnectionRegistry::Unregister(const SocketConnection* connection) {
+    auto& shard = ShardFor(connection);
+    boost::lock_guard guard(shard.mutex);
+    if (shard.connections.erase(connection) > 0) {
+        --size_;
+    }
+}
+
+std::vector<boost::weak_ptr<SocketConnection>> ConnectionRegistry::Snapshot() const {
+    std::vector<boost::weak_ptr<SocketConnection>> connections;
+    connections.reserve(Size());
+
+    for (const auto& shard : shards_) {
+        boost::lock_guard guard(shard.mutex);
+        for (const auto& [key, connection] : shard.connections) {
+            connections.push_back(connection);
+        }
+    }
+    return connections;
+}
+
+size_t ConnectionRegistry::Size() const {
+    return size_.load(boost::memory_order_relaxed);
+}
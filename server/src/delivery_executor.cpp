@@ -0,0 +1,48 @@
+#include "../include/delivery_executor.h"
+#include <functional>
+#include <thread>
+
+namespace {
+    constexpr size_t kShardsPerThread = 8;
+
+    size_t DefaultThreadCount() {
+        const size_t cores = std::thread::hardware_concurrency();
+        return cores > 0 ? cores : 1;
+    }
+}
+
+DeliveryExecutor::DeliveryExecutor(const size_t thread_count, const size_t shard_count)
+    : thread_count_(thread_count > 0 ? thread_count : 1),
+      pool_(thread_count_)
+{
+    const size_t shards = shard_count > 0 ? shard_count : thread_count_ * kShardsPerThread;
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.emplace_back(boost::asio::make_strand(pool_.get_executor()));
+    }
+}
+
+DeliveryExecutor::~DeliveryExecutor() {
+    pool_.join();
+}
+
+DeliveryExecutor& DeliveryExecutor::GetInstance() {
+    static DeliveryExecutor instance(DefaultThreadCount(), 0);
+    return instance;
+}
+
+DeliveryExecutor::Shard DeliveryExecutor::ShardFor(const std::string_view key) const {
+    return shards_[std::hash<std::string_view>{}(key) % shards_.size()];
+}
+
+size_t DeliveryExecutor::ThreadCount() const {
+    return thread_count_;
+}
+
+size_t DeliveryExecutor::ShardCount() const {
+    return shards_.size();
+}
+
+void DeliveryExecutor::Stop() {
+    pool_.stop();
+}
@@ -0,0 +1,77 @@
+#include "../include/graceful_shutdown.h"
+#include "../include/connection_registry.h"
+#include "../include/socket_connection.h"
+#include <algorithm>
+
+GracefulShutdown::GracefulShutdown(
+    boost::asio::io_context& ctx,
+    ShutdownOptions options,
+    std::function<void(bool drained)> on_complete
+) :
+    batch_timer_(ctx),
+    deadline_timer_(ctx),
+    options_(options),
+    on_complete_(std::move(on_complete)) {}
+
+void GracefulShutdown::Start() {
+    connections_ = ConnectionRegistry::GetInstance().Snapshot();
+    next_connection_ = 0;
+
+    deadline_timer_.expires_after(options_.drain_timeout);
+    deadline_timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+        if (!ec) self->Finish(false);
+    });
+
+    CloseNextBatch();
+}
+
+void GracefulShutdown::Abort() {
+    Finish(false);
+}
+
+void GracefulShutdown::CloseNextBatch() {
+    if (finished_) return;
+
+    const size_t batch = std::max<size_t>(options_.close_batch, 1);
+    const size_t end = std::min(connections_.size(), next_connection_ + batch);
+    for (; next_connection_ < end; ++next_connection_) {
+        if (const auto connection = connections_[next_connection_].lock()) {
+            connection->BeginShutdown();
+        }
+    }
+
+    if (next_connection_ < connections_.size()) {
+        batch_timer_.expires_after(options_.close_interval);
+        batch_timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+            if (!ec) self->CloseNextBatch();
+        });
+        return;
+    }
+
+    connections_.clear();
+    AwaitDrain();
+}
+
+void GracefulShutdown::AwaitDrain() {
+    if (finished_) return;
+
+    if (ConnectionRegistry::GetInstance().Size() == 0) {
+        Finish(true);
+        return;
+    }
+
+    batch_timer_.expires_after(options_.close_interval);
+    batch_timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+        if (!ec) self->AwaitDrain();
+    });
+}
+
+void GracefulShutdown::Finish(const bool drained) {
+    if (finished_) return;
+    finished_ = true;
+
+    batch_timer_.cancel();
+    deadline_timer_.cancel();
+    connections_.clear();
+    on_complete_(drained);
+}
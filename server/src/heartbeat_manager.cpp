@@ -0,0 +1,119 @@
+#include "../include/heartbeat_manager.h"
+#include "../include/socket_connection.h"
+#include <boost/thread/lock_guard.hpp>
+
+HeartbeatManager::HeartbeatManager(const std::chrono::milliseconds tick, const size_t slot_count)
+    : tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1)),
+      ticker_(ticker_context_),
+      next_tick_(std::chrono::steady_clock::now())
+{
+    for (auto& shard : shards_) {
+        shard.wheel = TimerWheel(slot_count);
+    }
+    ArmTicker();
+    ticker_thread_ = std::thread([this] { ticker_context_.run(); });
+}
+
+HeartbeatManager::~HeartbeatManager() {
+    ticker_context_.stop();
+    if (ticker_thread_.joinable()) {
+        ticker_thread_.join();
+    }
+}
+
+HeartbeatManager& HeartbeatManager::GetInstance() {
+    // Leaked, so the ticker thread is never joined from a static destructor
+    // and connections released at exit can still cancel their entries.
+    static auto* instance = new HeartbeatManager();
+    return *instance;
+}
+
+uint32_t HeartbeatManager::ShardFor(const SocketConnection* connection) {
+    // Connections are 16-byte aligned; mix the address so the low bits of the
+    // shard index are not always zero.
+    const uint64_t mixed = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(connection)) * 0x9e3779b97f4a7c15ull;
+    return static_cast<uint32_t>((mixed >> 32) % kShardCount);
+}
+
+void HeartbeatManager::Shard::Release(const uint32_t target) {
+    targets[target].reset();
+    free_targets.push_back(target);
+}
+
+HeartbeatManager::Handle HeartbeatManager::Schedule(
+    const boost::shared_ptr<SocketConnection>& connection,
+    const std::chrono::milliseconds delay
+) {
+    const auto ticks = static_cast<uint64_t>((delay + tick_ - std::chrono::milliseconds(1)) / tick_);
+    const uint32_t index = ShardFor(connection.get());
+    auto& shard = shards_[index];
+
+    boost::lock_guard guard(shard.mutex);
+    uint32_t target;
+    if (!shard.free_targets.empty()) {
+        target = shard.free_targets.back();
+        shard.free_targets.pop_back();
+        shard.targets[target] = connection;
+    } else {
+        target = static_cast<uint32_t>(shard.targets.size());
+        shard.targets.emplace_back(connection);
+    }
+    return {shard.wheel.Schedule(ticks, target), index};
+}
+
+void HeartbeatManager::Cancel(const Handle handle) {
+    if (!handle.timer.Valid()) return;
+
+    auto& shard = shards_[handle.shard];
+    boost::lock_guard guard(shard.mutex);
+
+    if (uint64_t target; shard.wheel.Cancel(handle.timer, &target)) {
+        shard.Release(static_cast<uint32_t>(target));
+    }
+}
+
+size_t HeartbeatManager::Size() const {
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+        boost::lock_guard guard(shard.mutex);
+        size += shard.wheel.Size();
+    }
+    return size;
+}
+
+void HeartbeatManager::ArmTicker() {
+    next_tick_ += tick_;
+    ticker_.expires_at(next_tick_);
+    ticker_.async_wait([this](const boost::system::error_code& ec) {
+        if (ec) return;
+        Tick();
+        ArmTicker();
+    });
+}
+
+void HeartbeatManager::Tick() {
+    std::vector<uint64_t> expired;
+    std::vector<boost::shared_ptr<SocketConnection>> due;
+
+    for (auto& shard : shards_) {
+        expired.clear();
+        boost::lock_guard guard(shard.mutex);
+        shard.wheel.Advance(expired);
+
+        for (const uint64_t target : expired) {
+            if (auto connection = shard.targets[target].lock()) {
+                due.push_back(std::move(connection));
+            }
+            shard.Release(static_cast<uint32_t>(target));
+        }
+    }
+
+    for (auto& connection : due) {
+        post(
+            connection->GetExecutor(),
+            [connection] {
+                connection->HandleHeartbeatDue();
+            }
+        );
+    }
+}
@@ -0,0 +1,544 @@
+#include "../include/history_log.h"
+#include "../include/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <boost/thread/lock_guard.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr uint32_t kRecordMagic = 0x31484d52;  // "RMH1"
+    constexpr uint32_t kIndexMagic = 0x31494d52;   // "RMI1"
+    constexpr std::string_view kSegmentSuffix = ".seg";
+    constexpr std::string_view kIndexSuffix = ".idx";
+
+    std::atomic<HistoryLog*> g_active{nullptr};
+
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t body_length;
+        uint32_t checksum;
+        uint16_t room_length;
+        uint16_t sender_length;
+        uint8_t encoding;
+        uint8_t padding[3];
+    };
+
+    static_assert(sizeof(RecordHeader) == 20);
+
+    constexpr uint32_t kChecksumSeed = 2166136261u;
+
+    // FNV-1a over the record body; catches torn and overwritten tails. Takes
+    // the running hash so a body can be checksummed in parts.
+    uint32_t Checksum(const std::string_view data, uint32_t hash = kChecksumSeed) {
+        for (const char c : data) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    fs::path PathFor(const fs::path& directory, const uint64_t id, const std::string_view suffix) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%020llu", static_cast<unsigned long long>(id));
+        return directory / (std::string(name) + std::string(suffix));
+    }
+
+    std::vector<uint64_t> ListSegments(const fs::path& directory) {
+        std::vector<uint64_t> ids;
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            if (entry.path().extension() != kSegmentSuffix) continue;
+            try {
+                ids.push_back(std::stoull(entry.path().stem().string()));
+            } catch (const std::exception&) {}
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    // A record as stored, viewing into the mapped segment.
+    struct RecordView {
+        std::string_view room;
+        std::string_view sender;
+        std::string_view payload;
+        std::string_view body;
+        uint32_t checksum;
+        WireProtocol encoding;
+    };
+
+    // Reads the record at offset and advances past it. Fails on a truncated
+    // or foreign header, which ends the readable part of the segment.
+    bool NextRecord(const std::string_view data, size_t& offset, RecordView& record) {
+        if (data.size() - offset < sizeof(RecordHeader)) return false;
+
+        RecordHeader header;
+        std::memcpy(&header, data.data() + offset, sizeof(header));
+        if (header.magic != kRecordMagic
+            || header.body_length > data.size() - offset - sizeof(header)
+            || static_cast<size_t>(header.room_length) + header.sender_length > header.body_length) {
+            return false;
+        }
+
+        record.body = data.substr(offset + sizeof(header), header.body_length);
+        record.room = record.body.substr(0, header.room_length);
+        record.sender = record.body.substr(header.room_length, header.sender_length);
+        record.payload = record.body.substr(static_cast<size_t>(header.room_length) + header.sender_length);
+        record.checksum = header.checksum;
+        record.encoding = static_cast<WireProtocol>(header.encoding);
+        offset += sizeof(header) + header.body_length;
+        return true;
+    }
+
+    class MappedSegment {
+    public:
+        explicit MappedSegment(const fs::path& path) {
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return;
+
+            struct stat info{};
+            if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+                size_ = static_cast<size_t>(info.st_size);
+                void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                data_ = mapped == MAP_FAILED ? nullptr : static_cast<const char*>(mapped);
+            }
+            ::close(fd);
+        }
+
+        ~MappedSegment() {
+            if (data_) ::munmap(const_cast<char*>(data_), size_);
+        }
+
+        MappedSegment(const MappedSegment&) = delete;
+        MappedSegment& operator=(const MappedSegment&) = delete;
+
+        std::string_view Data() const {
+            return data_ ? std::string_view(data_, size_) : std::string_view();
+        }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    using RoomCounts = std::map<std::string, uint32_t, std::less<>>;
+
+    std::optional<RoomCounts> ReadIndex(const fs::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        uint32_t magic = 0;
+        uint32_t rooms = 0;
+        if (!in.read(reinterpret_cast<char*>(&magic), sizeof(magic))
+            || !in.read(reinterpret_cast<char*>(&rooms), sizeof(rooms))
+            || magic != kIndexMagic) {
+            return std::nullopt;
+        }
+
+        RoomCounts counts;
+        for (uint32_t i = 0; i < rooms; ++i) {
+            uint16_t length = 0;
+            uint32_t count = 0;
+            std::string name;
+            if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) return std::nullopt;
+            name.resize(length);
+            if (!in.read(name.data(), length) || !in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+                return std::nullopt;
+            }
+            counts.emplace(std::move(name), count);
+        }
+        return counts;
+    }
+
+    RoomCounts CountRecords(const std::string_view data) {
+        RoomCounts counts;
+        RecordView record;
+        for (size_t offset = 0; NextRecord(data, offset, record);) {
+            const auto it = counts.find(record.room);
+            if (it != counts.end()) {
+                ++it->second;
+            } else {
+                counts.emplace(std::string(record.room), 1);
+            }
+        }
+        return counts;
+    }
+
+    // Written to a temporary name and renamed, so replay sees either a
+    // complete index or none and falls back to counting the segment.
+    void WriteIndex(const fs::path& path, const RoomCounts& counts) {
+        auto temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            const uint32_t magic = kIndexMagic;
+            const auto rooms = static_cast<uint32_t>(counts.size());
+            out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+            out.write(reinterpret_cast<const char*>(&rooms), sizeof(rooms));
+            for (const auto& [name, count] : counts) {
+                const auto length = static_cast<uint16_t>(name.size());
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                out.write(name.data(), length);
+                out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            }
+        }
+        std::error_code error;
+        fs::rename(temporary, path, error);
+    }
+
+    void SyncFile(const int fd) {
+#ifdef __linux__
+        ::fdatasync(fd);
+#else
+        ::fsync(fd);
+#endif
+    }
+
+    void SyncDirectory(const fs::path& directory) {
+        if (const int fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC); fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+}
+
+HistoryLog::HistoryLog(HistoryLogOptions options)
+    : options_(std::move(options))
+{
+    if (options_.directory.empty()) {
+        throw std::invalid_argument("History log directory cannot be empty");
+    }
+    fs::create_directories(options_.directory);
+
+    // Never append to an existing segment: its tail may be torn. Segments
+    // left without an index by a crash get one now, so later replays can
+    // skip them like any other.
+    const auto existing = ListSegments(options_.directory);
+    for (const uint64_t id : existing) {
+        if (const auto index = PathFor(options_.directory, id, kIndexSuffix); !fs::exists(index)) {
+            const MappedSegment segment(PathFor(options_.directory, id, kSegmentSuffix));
+            WriteIndex(index, CountRecords(segment.Data()));
+        }
+    }
+    segment_id_ = existing.empty() ? 0 : existing.back();
+
+    writer_ = std::thread(&HistoryLog::WriterLoop, this);
+}
+
+HistoryLog::~HistoryLog() {
+    {
+        boost::lock_guard guard(mutex_);
+        stopping_ = true;
+    }
+    pending_ready_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+HistoryLog* HistoryLog::Active() {
+    return g_active.load(std::memory_order_acquire);
+}
+
+void HistoryLog::SetActive(HistoryLog* log) {
+    g_active.store(log, std::memory_order_release);
+}
+
+void HistoryLog::Append(const std::string_view room, const BroadcastMessage& message) {
+    const std::string_view sender = message.Sender();
+    const std::string_view payload = message.Data();
+    if (room.size() > UINT16_MAX || sender.size() > UINT16_MAX
+        || room.size() + sender.size() + payload.size() > UINT32_MAX) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    RecordHeader header{};
+    header.magic = kRecordMagic;
+    header.body_length = static_cast<uint32_t>(room.size() + sender.size() + payload.size());
+    header.room_length = static_cast<uint16_t>(room.size());
+    header.sender_length = static_cast<uint16_t>(sender.size());
+    header.encoding = static_cast<uint8_t>(message.Encoding());
+
+    header.checksum = Checksum(payload, Checksum(sender, Checksum(room)));
+
+    bool wake = false;
+    {
+        boost::lock_guard guard(mutex_);
+        if (stopping_ || pending_.size() + sizeof(header) + header.body_length > options_.max_pending_bytes) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        wake = pending_.empty();
+        pending_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        pending_.append(room);
+        pending_.append(sender);
+        pending_.append(payload);
+        ++pending_records_;
+        ++appended_;
+    }
+
+    if (wake) {
+        pending_ready_.notify_one();
+    }
+}
+
+void HistoryLog::Stage(std::vector<RecoveredRoom> rooms) {
+    boost::lock_guard guard(recovered_mutex_);
+    for (auto& room : rooms) {
+        recovered_[std::move(room.name)] = std::move(room.messages);
+    }
+}
+
+std::vector<BroadcastMessagePtr> HistoryLog::TakeRecovered(const std::string_view room) {
+    boost::lock_guard guard(recovered_mutex_);
+    const auto it = recovered_.find(room);
+    if (it == recovered_.end()) return {};
+
+    auto messages = std::move(it->second);
+    recovered_.erase(it);
+    return messages;
+}
+
+void HistoryLog::Flush() {
+    boost::unique_lock lock(mutex_);
+    const uint64_t target = appended_;
+    committed_.wait(lock, [&] { return committed_records_ >= target; });
+}
+
+uint64_t HistoryLog::Written() const {
+    return written_.load(std::memory_order_relaxed);
+}
+
+uint64_t HistoryLog::Dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+void HistoryLog::WriterLoop() {
+    std::string batch;
+
+    for (;;) {
+        {
+            boost::unique_lock lock(mutex_);
+            pending_ready_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) break;
+        }
+
+        // Give concurrent appenders a moment to join this batch and share
+        // its sync, unless the service is shutting down.
+        if (options_.commit_window.count() > 0) {
+            boost::unique_lock lock(mutex_);
+            pending_ready_.wait_for(
+                lock,
+                boost::chrono::milliseconds(options_.commit_window.count()),
+                [&] { return stopping_; }
+            );
+        }
+
+        uint64_t records;
+        {
+            boost::lock_guard guard(mutex_);
+            batch.swap(pending_);
+            records = pending_records_;
+            pending_records_ = 0;
+        }
+
+        if (WriteBatch(batch)) {
+            written_.fetch_add(records, std::memory_order_relaxed);
+        } else {
+            dropped_.fetch_add(records, std::memory_order_relaxed);
+        }
+        batch.clear();
+
+        {
+            boost::lock_guard guard(mutex_);
+            committed_records_ += records;
+        }
+        committed_.notify_all();
+    }
+
+    SealSegment();
+}
+
+bool HistoryLog::WriteBatch(const std::string_view batch) {
+    if (segment_fd_ >= 0 && segment_size_ >= options_.segment_bytes) {
+        SealSegment();
+    }
+    if (segment_fd_ < 0) {
+        OpenSegment();
+        if (segment_fd_ < 0) return false;
+    }
+
+    for (size_t offset = 0; offset < batch.size();) {
+        const ssize_t written = ::write(segment_fd_, batch.data() + offset, batch.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            Logger::GetInstance().Log(LogLevel::Error, "History log write failed", {{"detail", std::strerror(errno)}});
+            // The segment may now end in a partial record; start a fresh one.
+            SealSegment();
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    SyncFile(segment_fd_);
+
+    segment_size_ += batch.size();
+    CountRooms(batch);
+    return true;
+}
+
+void HistoryLog::CountRooms(const std::string_view batch) {
+    RecordView record;
+    for (size_t offset = 0; NextRecord(batch, offset, record);) {
+        const auto it = segment_rooms_.find(record.room);
+        if (it != segment_rooms_.end()) {
+            ++it->second;
+        } else {
+            segment_rooms_.emplace(std::string(record.room), 1);
+        }
+    }
+}
+
+void HistoryLog::OpenSegment() {
+    const auto path = PathFor(options_.directory, ++segment_id_, kSegmentSuffix);
+    segment_fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+    if (segment_fd_ < 0) {
+        Logger::GetInstance().Log(LogLevel::Error, "Failed to open history segment", {
+            {"path", path.string()},
+            {"detail", std::strerror(errno)}
+        });
+        return;
+    }
+    segment_size_ = 0;
+    SyncDirectory(options_.directory);
+}
+
+void HistoryLog::SealSegment() {
+    if (segment_fd_ < 0) return;
+
+    ::close(segment_fd_);
+    segment_fd_ = -1;
+
+    WriteIndex(PathFor(options_.directory, segment_id_, kIndexSuffix), segment_rooms_);
+    segment_rooms_.clear();
+
+    EnforceRetention();
+}
+
+void HistoryLog::EnforceRetention() {
+    const auto ids = ListSegments(options_.directory);
+    if (ids.size() <= options_.max_segments) return;
+
+    std::error_code error;
+    for (size_t i = 0; i < ids.size() - options_.max_segments; ++i) {
+        fs::remove(PathFor(options_.directory, ids[i], kSegmentSuffix), error);
+        fs::remove(PathFor(options_.directory, ids[i], kIndexSuffix), error);
+    }
+}
+
+std::vector<RecoveredRoom> HistoryLog::Replay(const std::string& directory, const size_t tail_messages) {
+    std::vector<RecoveredRoom> recovered;
+    std::error_code error;
+    if (tail_messages == 0 || !fs::is_directory(directory, error)) {
+        return recovered;
+    }
+
+    struct RoomTail {
+        size_t needed;
+        // Newest segment first; each chunk is in write order.
+        std::vector<std::vector<BroadcastMessagePtr>> chunks;
+    };
+    std::map<std::string, RoomTail, std::less<>> tails;
+
+    const auto needed = [&](const std::string_view room) -> size_t {
+        const auto it = tails.find(room);
+        return it == tails.end() ? tail_messages : it->second.needed;
+    };
+
+    auto ids = ListSegments(directory);
+    std::reverse(ids.begin(), ids.end());
+
+    for (const uint64_t id : ids) {
+        auto counts = ReadIndex(PathFor(directory, id, kIndexSuffix));
+        if (counts && std::none_of(counts->begin(), counts->end(), [&](const auto& entry) {
+            return needed(entry.first) > 0;
+        })) {
+            continue;
+        }
+
+        const MappedSegment segment(PathFor(directory, id, kSegmentSuffix));
+        const auto data = segment.Data();
+        if (!counts) {
+            counts = CountRecords(data);
+        }
+
+        // Records before a room's tail in this segment are stepped over.
+        std::map<std::string_view, uint32_t> skip;
+        std::map<std::string_view, std::vector<BroadcastMessagePtr>> taken;
+        for (const auto& [room, count] : *counts) {
+            const size_t want = needed(room);
+            skip[room] = count > want ? static_cast<uint32_t>(count - want) : 0;
+        }
+
+        // The header has already been bounds-checked, so a record whose body
+        // fails its checksum is stepped over like any other.
+        size_t corrupt = 0;
+        RecordView record;
+        for (size_t offset = 0; NextRecord(data, offset, record);) {
+            const auto it = skip.find(record.room);
+            if (it == skip.end() || needed(record.room) == 0) continue;
+            if (it->second > 0) {
+                --it->second;
+                continue;
+            }
+            if (Checksum(record.body) != record.checksum) {
+                ++corrupt;
+                continue;
+            }
+
+            taken[it->first].push_back(MakeBroadcastMessage(
+                std::string(record.payload),
+                record.encoding,
+                std::string(record.sender)
+            ));
+        }
+
+        if (corrupt > 0) {
+            Logger::GetInstance().Log(LogLevel::Warn, "Skipped corrupt history records", {
+                {"segment", id},
+                {"records", corrupt}
+            });
+        }
+
+        for (auto& [room, messages] : taken) {
+            auto it = tails.find(room);
+            if (it == tails.end()) {
+                it = tails.emplace(std::string(room), RoomTail{tail_messages, {}}).first;
+            }
+            auto& tail = it->second;
+            if (messages.size() > tail.needed) {
+                messages.erase(messages.begin(), messages.end() - static_cast<std::ptrdiff_t>(tail.needed));
+            }
+            tail.needed -= messages.size();
+            tail.chunks.push_back(std::move(messages));
+        }
+    }
+
+    recovered.reserve(tails.size());
+    for (auto& [name, tail] : tails) {
+        RecoveredRoom room{name, {}};
+        for (auto chunk = tail.chunks.rbegin(); chunk != tail.chunks.rend(); ++chunk) {
+            room.messages.insert(room.messages.end(), chunk->begin(), chunk->end());
+        }
+        recovered.push_back(std::move(room));
+    }
+    return recovered;
+}
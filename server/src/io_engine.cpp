@@ -0,0 +1,187 @@
+#include "../include/io_engine.h"
+#include "../include/logger.h"
+#include <algorithm>
+#include <atomic>
+#include <pthread.h>
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <time.h>
+#endif
+
+namespace {
+    std::atomic<IoEngine*> active_engine{nullptr};
+
+#if defined(__APPLE__)
+    double ThreadCpuSeconds(const pthread_t handle) {
+        thread_basic_info_data_t info;
+        mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+        if (thread_info(pthread_mach_thread_np(handle), THREAD_BASIC_INFO,
+                        reinterpret_cast<thread_info_t>(&info), &count) != KERN_SUCCESS) {
+            return 0.0;
+        }
+        return info.user_time.seconds + info.system_time.seconds
+            + (info.user_time.microseconds + info.system_time.microseconds) / 1e6;
+    }
+#elif defined(__linux__)
+    double ThreadCpuSeconds(const pthread_t handle) {
+        clockid_t clock;
+        timespec now{};
+        if (pthread_getcpuclockid(handle, &clock) != 0 || clock_gettime(clock, &now) != 0) {
+            return 0.0;
+        }
+        return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) / 1e9;
+    }
+#else
+    double ThreadCpuSeconds(pthread_t) {
+        return 0.0;
+    }
+#endif
+
+    void PinCurrentThread(const int cpu) {
+#ifdef __linux__
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+            Logger::GetInstance().Log(LogLevel::Warn, "Failed to pin io thread", {{"cpu", cpu}});
+        }
+#else
+        // macOS only offers affinity hints between threads, not CPU binding.
+        (void)cpu;
+#endif
+    }
+}
+
+double IoEngine::ThreadUsage::Utilization() const {
+    return wall_seconds > 0.0 ? std::min(1.0, busy_seconds / wall_seconds) : 0.0;
+}
+
+IoEngine::IoEngine(IoEngineOptions options)
+    : options_(options)
+{
+    options_.threads = std::max<size_t>(1, options_.threads);
+
+    if (options_.mode == IoMode::PerCore) {
+        for (size_t i = 0; i < options_.threads; ++i) {
+            contexts_.push_back(std::make_unique<boost::asio::io_context>(1));
+        }
+    } else {
+        contexts_.push_back(std::make_unique<boost::asio::io_context>(static_cast<int>(options_.threads)));
+    }
+
+    for (const auto& ctx : contexts_) {
+        work_guards_.emplace_back(boost::asio::make_work_guard(*ctx));
+    }
+}
+
+IoEngine::~IoEngine() {
+    if (Active() == this) {
+        SetActive(nullptr);
+    }
+    Stop();
+}
+
+IoEngine* IoEngine::Active() {
+    return active_engine.load(std::memory_order_acquire);
+}
+
+void IoEngine::SetActive(IoEngine* engine) {
+    active_engine.store(engine, std::memory_order_release);
+}
+
+const char* IoEngine::BackendName() {
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+    return "io_uring";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+    return "epoll";
+#elif defined(BOOST_ASIO_HAS_KQUEUE)
+    return "kqueue";
+#else
+    return "select";
+#endif
+}
+
+size_t IoEngine::ThreadCount() const {
+    return options_.threads;
+}
+
+size_t IoEngine::ContextCount() const {
+    return contexts_.size();
+}
+
+boost::asio::io_context& IoEngine::Context(const size_t index) const {
+    return *contexts_.at(index);
+}
+
+void IoEngine::Start() {
+    boost::mutex::scoped_lock lock(threads_mutex_);
+    if (!threads_.empty()) return;
+
+    started_ = std::chrono::steady_clock::now();
+    threads_.reserve(options_.threads);
+    for (size_t i = 0; i < options_.threads; ++i) {
+        threads_.emplace_back(&IoEngine::Run, this, i);
+    }
+}
+
+void IoEngine::Stop() {
+    for (const auto& ctx : contexts_) {
+        ctx->stop();
+    }
+
+    // Join outside the lock: Usage() takes it too, and an io thread may be
+    // serving /metrics while it stops.
+    std::vector<std::thread> threads;
+    {
+        boost::mutex::scoped_lock lock(threads_mutex_);
+        threads.swap(threads_);
+    }
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+std::vector<IoEngine::ThreadUsage> IoEngine::Usage() const {
+    boost::mutex::scoped_lock lock(threads_mutex_);
+    std::vector<ThreadUsage> usage;
+    usage.reserve(threads_.size());
+
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        // native_handle() is not const, but reading the thread's clock does
+        // not change it.
+        const auto handle = const_cast<std::thread&>(threads_[i]).native_handle();
+        usage.push_back({i, i % contexts_.size(), CpuFor(i), ThreadCpuSeconds(handle), wall});
+    }
+    return usage;
+}
+
+void IoEngine::Run(const size_t thread_index) {
+    if (const int cpu = CpuFor(thread_index); cpu >= 0) {
+        PinCurrentThread(cpu);
+    }
+
+    // A handler that throws must not take the thread down; run() returns
+    // normally only once the context is stopped.
+    auto& ctx = *contexts_[thread_index % contexts_.size()];
+    while (!ctx.stopped()) {
+        try {
+            ctx.run();
+        } catch (const std::exception& e) {
+            Logger::GetInstance().Log(LogLevel::Error, "io thread exception", {
+                {"thread", thread_index},
+                {"detail", e.what()}
+            });
+        }
+    }
+}
+
+int IoEngine::CpuFor(const size_t thread_index) const {
+    if (!options_.pin_cpus) return -1;
+    const size_t cpu_count = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<int>(thread_index % cpu_count);
+}
@@ -0,0 +1,284 @@
+#include "../include/logger.h"
+#include <bit>
+#include <charconv>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+    constexpr auto kIdleSleepMin = std::chrono::microseconds(100);
+    constexpr auto kIdleSleepMax = std::chrono::milliseconds(10);
+
+    std::string_view LevelName(const LogLevel level) {
+        switch (level) {
+            case LogLevel::Debug: return "debug";
+            case LogLevel::Info: return "info";
+            case LogLevel::Warn: return "warn";
+            case LogLevel::Error: return "error";
+            case LogLevel::Off: break;
+        }
+        return "off";
+    }
+
+    // Appends into a fixed buffer and silently truncates at its end.
+    class RecordWriter {
+    public:
+        RecordWriter(char* buffer, const size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+        void Append(const std::string_view text) {
+            const size_t count = std::min(text.size(), capacity_ - length_);
+            text.copy(buffer_ + length_, count);
+            length_ += count;
+        }
+
+        void Append(const char c) {
+            if (length_ < capacity_) buffer_[length_++] = c;
+        }
+
+        void AppendNumber(const int64_t value) {
+            char digits[24];
+            const auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+            Append(std::string_view(digits, end - digits));
+        }
+
+        void AppendReal(const double value) {
+            char digits[32];
+            const auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+            Append(std::string_view(digits, end - digits));
+        }
+
+        // logfmt: values with spaces, quotes or '=' are quoted and escaped.
+        void AppendValue(const std::string_view value) {
+            const bool quote = value.empty() || value.find_first_of(" =\"\\\n\t") != std::string_view::npos;
+            if (!quote) {
+                Append(value);
+                return;
+            }
+
+            Append('"');
+            for (const char c : value) {
+                switch (c) {
+                    case '"': Append("\\\""); break;
+                    case '\\': Append("\\\\"); break;
+                    case '\n': Append("\\n"); break;
+                    case '\t': Append("\\t"); break;
+                    default: Append(c);
+                }
+            }
+            Append('"');
+        }
+
+        size_t Length() const {
+            return length_;
+        }
+
+    private:
+        char* buffer_;
+        size_t capacity_;
+        size_t length_ = 0;
+    };
+
+    void AppendTimestamp(std::string& out, const std::chrono::system_clock::time_point time) {
+        const auto since_epoch = time.time_since_epoch();
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(since_epoch - seconds);
+
+        const std::time_t calendar = seconds.count();
+        std::tm utc{};
+        gmtime_r(&calendar, &utc);
+
+        char text[40];
+        const int length = std::snprintf(
+            text, sizeof(text), "%04d-%02d-%02dT%02d:%02d:%02d.%06lldZ",
+            utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+            utc.tm_hour, utc.tm_min, utc.tm_sec,
+            static_cast<long long>(micros.count()));
+        out.append(text, static_cast<size_t>(length));
+    }
+
+    void WriteToStderr(const std::string_view batch) {
+        std::fwrite(batch.data(), 1, batch.size(), stderr);
+        std::fflush(stderr);
+    }
+}
+
+Logger::Logger(LoggerOptions options)
+    : level_(options.level),
+      max_records_per_second_(options.max_records_per_second),
+      sink_(options.sink ? std::move(options.sink) : WriteToStderr)
+{
+    const size_t capacity = std::bit_ceil(std::max<size_t>(options.capacity, 2));
+    cells_ = std::make_unique<Cell[]>(capacity);
+    mask_ = capacity - 1;
+    for (size_t i = 0; i < capacity; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    writer_ = std::thread(&Logger::WriterLoop, this);
+}
+
+Logger::~Logger() {
+    stopping_.store(true, std::memory_order_release);
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+Logger& Logger::GetInstance() {
+    // Never destroyed, so objects torn down during static destruction can
+    // still log; the service flushes before it returns.
+    static auto* instance = new Logger();
+    return *instance;
+}
+
+bool Logger::Enabled(const LogLevel level) const {
+    return level != LogLevel::Off && level >= level_.load(std::memory_order_relaxed);
+}
+
+void Logger::SetLevel(const LogLevel level) {
+    level_.store(level, std::memory_order_relaxed);
+}
+
+void Logger::Log(const LogLevel level, const std::string_view message, const std::initializer_list<LogField> fields) {
+    if (!Enabled(level) || stopping_.load(std::memory_order_relaxed)) return;
+
+    if (!TryAcquireBudget()) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Claim a slot: the cell is free for this position when its sequence
+    // equals the position; a smaller sequence means the ring is full.
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[pos & mask_];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    RecordWriter record(cell->text, kMaxRecordBytes);
+    record.Append("msg=");
+    record.AppendValue(message);
+    for (const auto& field : fields) {
+        record.Append(' ');
+        record.Append(field.key);
+        record.Append('=');
+        switch (field.kind) {
+            case LogField::Kind::Integer: record.AppendNumber(field.number); break;
+            case LogField::Kind::Real: record.AppendReal(field.real); break;
+            case LogField::Kind::Text: record.AppendValue(field.text); break;
+        }
+    }
+
+    cell->level = level;
+    cell->time = std::chrono::system_clock::now();
+    cell->length = static_cast<uint16_t>(record.Length());
+    cell->sequence.store(pos + 1, std::memory_order_release);
+}
+
+bool Logger::TryAcquireBudget() {
+    if (max_records_per_second_ == 0) return true;
+
+    const int64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // The first caller of a new second resets the budget. A racing caller may
+    // count against the old window; the limit is approximate by design.
+    int64_t window = budget_window_.load(std::memory_order_relaxed);
+    if (window != second && budget_window_.compare_exchange_strong(window, second, std::memory_order_relaxed)) {
+        budget_used_.store(0, std::memory_order_relaxed);
+    }
+    return budget_used_.fetch_add(1, std::memory_order_relaxed) < max_records_per_second_;
+}
+
+void Logger::Flush() {
+    const size_t target = enqueue_pos_.load(std::memory_order_acquire);
+    while (written_pos_.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(kIdleSleepMin);
+    }
+}
+
+uint64_t Logger::Dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+uint64_t Logger::Suppressed() const {
+    return suppressed_.load(std::memory_order_relaxed);
+}
+
+bool Logger::DrainInto(std::string& batch) {
+    bool drained = false;
+    for (;;) {
+        Cell& cell = cells_[dequeue_pos_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+            // Empty, or the producer of this slot has not finished yet.
+            return drained;
+        }
+
+        batch.append("ts=");
+        AppendTimestamp(batch, cell.time);
+        batch.append(" level=");
+        batch.append(LevelName(cell.level));
+        batch.push_back(' ');
+        batch.append(cell.text, cell.length);
+        batch.push_back('\n');
+
+        cell.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_pos_;
+        drained = true;
+    }
+}
+
+void Logger::ReportLosses(std::string& batch) {
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    const uint64_t suppressed = suppressed_.load(std::memory_order_relaxed);
+    if (dropped == reported_dropped_ && suppressed == reported_suppressed_) return;
+
+    batch.append("ts=");
+    AppendTimestamp(batch, std::chrono::system_clock::now());
+    batch.append(" level=warn msg=\"log records lost\" dropped=");
+    batch.append(std::to_string(dropped - reported_dropped_));
+    batch.append(" suppressed=");
+    batch.append(std::to_string(suppressed - reported_suppressed_));
+    batch.push_back('\n');
+
+    reported_dropped_ = dropped;
+    reported_suppressed_ = suppressed;
+}
+
+void Logger::WriterLoop() {
+    std::string batch;
+    auto idle_sleep = kIdleSleepMin;
+
+    for (;;) {
+        const bool stopping = stopping_.load(std::memory_order_acquire);
+        const bool drained = DrainInto(batch);
+        ReportLosses(batch);
+
+        if (!batch.empty()) {
+            sink_(batch);
+            batch.clear();
+        }
+        written_pos_.store(dequeue_pos_, std::memory_order_release);
+
+        if (drained) {
+            idle_sleep = kIdleSleepMin;
+            continue;
+        }
+        if (stopping) {
+            return;
+        }
+
+        std::this_thread::sleep_for(idle_sleep);
+        idle_sleep = std::min<std::chrono::microseconds>(idle_sleep * 2, kIdleSleepMax);
+    }
+}
@@ -0,0 +1,108 @@
+#include "../include/message_history.h"
+#include <algorithm>
+#include <boost/thread/lock_guard.hpp>
+
+MessageHistory::MessageHistory(const HistoryLimits limits)
+    : limits_(limits) {}
+
+uint64_t MessageHistory::Append(BroadcastMessagePtr message) {
+    boost::lock_guard guard(history_mutex_);
+
+    const uint64_t sequence = next_sequence_++;
+    if (limits_.max_messages == 0 || message->Size() > limits_.max_bytes) {
+        // Too large to retain. It is skipped without disturbing what is
+        // retained, and its sequence is simply missing from pages.
+        return sequence;
+    }
+
+    while (count_ > 0 && (count_ == limits_.max_messages || bytes_ + message->Size() > limits_.max_bytes)) {
+        EvictOldest();
+    }
+
+    bytes_ += message->Size();
+    if (count_ < ring_.size()) {
+        ring_[(head_ + count_) % ring_.size()] = {sequence, std::move(message)};
+    } else {
+        // Storage grows on demand up to max_messages so idle rooms stay small.
+        std::rotate(ring_.begin(), ring_.begin() + static_cast<std::ptrdiff_t>(head_), ring_.end());
+        head_ = 0;
+        ring_.push_back({sequence, std::move(message)});
+    }
+    ++count_;
+
+    return sequence;
+}
+
+HistorySlice MessageHistory::Tail(const size_t count) const {
+    boost::lock_guard guard(history_mutex_);
+    const size_t taken = std::min(count, count_);
+    return Slice(count_ - taken, taken);
+}
+
+HistorySlice MessageHistory::Page(const uint64_t after_sequence, const size_t limit) const {
+    boost::lock_guard guard(history_mutex_);
+    if (count_ == 0) {
+        return {};
+    }
+
+    // Sequences increase along the ring but may have gaps where a message was
+    // too large to keep, so search for the first one past the cursor.
+    size_t low = 0;
+    size_t high = count_;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (At(middle).sequence <= after_sequence) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return Slice(low, std::min(limit, count_ - low));
+}
+
+uint64_t MessageHistory::FirstSequence() const {
+    boost::lock_guard guard(history_mutex_);
+    return count_ == 0 ? next_sequence_ : ring_[head_].sequence;
+}
+
+uint64_t MessageHistory::LastSequence() const {
+    boost::lock_guard guard(history_mutex_);
+    return next_sequence_ - 1;
+}
+
+size_t MessageHistory::Size() const {
+    boost::lock_guard guard(history_mutex_);
+    return count_;
+}
+
+size_t MessageHistory::Bytes() const {
+    boost::lock_guard guard(history_mutex_);
+    return bytes_;
+}
+
+void MessageHistory::EvictOldest() {
+    auto& oldest = ring_[head_];
+    bytes_ -= oldest.message->Size();
+    oldest.message.reset();
+    head_ = (head_ + 1) % ring_.size();
+    --count_;
+
+    if (count_ == 0) {
+        head_ = 0;
+        ring_.clear();
+    }
+}
+
+const HistoryEntry& MessageHistory::At(const size_t offset) const {
+    return ring_[(head_ + offset) % ring_.size()];
+}
+
+HistorySlice MessageHistory::Slice(const size_t offset, const size_t count) const {
+    HistorySlice slice;
+    slice.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        slice.push_back(At(offset + i));
+    }
+    return slice;
+}
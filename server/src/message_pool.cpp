@@ -0,0 +1,148 @@
+#include "../include/message_pool.h"
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace {
+    // Marks the return stack of a pool whose thread has exited.
+    BroadcastMessage* const kClosed = reinterpret_cast<BroadcastMessage*>(alignof(BroadcastMessage));
+}
+
+// The messages one thread acquired. Threads that drop the last reference to
+// one of them hand it back through a lock-free stack, so the pool is
+// reference counted: the owning thread holds one reference and every message
+// it created holds another.
+struct ThreadMessagePool {
+    // Touched by the owning thread only.
+    std::vector<BroadcastMessage*> free_messages;
+    // Linked through BroadcastMessage::next_returned_. The owner always takes
+    // the whole stack, so a push never races with the pop of a single node.
+    std::atomic<BroadcastMessage*> returned{nullptr};
+    std::atomic<size_t> references{1};
+
+    void Unref() {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    void Destroy(const BroadcastMessage* message) {
+        delete message;
+        Unref();
+    }
+
+    void Keep(BroadcastMessage* message) {
+        if (free_messages.size() >= MessagePool::kMaxPooledPerThread) {
+            Destroy(message);
+            return;
+        }
+        free_messages.push_back(message);
+    }
+
+    void CollectReturned() {
+        BroadcastMessage* message = returned.exchange(nullptr, std::memory_order_acquire);
+        while (message) {
+            Keep(std::exchange(message, message->next_returned_));
+        }
+    }
+
+    // Called from any thread. Once the owner has exited the message is freed.
+    void Return(BroadcastMessage* message) {
+        BroadcastMessage* head = returned.load(std::memory_order_relaxed);
+        do {
+            if (head == kClosed) {
+                Destroy(message);
+                return;
+            }
+            message->next_returned_ = head;
+        } while (!returned.compare_exchange_weak(head, message, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Called by the owner as its thread exits. Messages still referenced
+    // elsewhere keep the pool alive until they are released.
+    void Close() {
+        for (const auto* message : std::exchange(free_messages, {})) {
+            Destroy(message);
+        }
+
+        BroadcastMessage* message = returned.exchange(kClosed, std::memory_order_acquire);
+        while (message) {
+            Destroy(std::exchange(message, message->next_returned_));
+        }
+        Unref();
+    }
+};
+
+namespace {
+    enum class PoolState : uint8_t {
+        Unborn,
+        Alive,
+        Dead
+    };
+
+    // Trivially destructible, so releases that happen while this thread's
+    // thread_locals are being destroyed can still tell the pool is gone.
+    thread_local PoolState t_pool_state = PoolState::Unborn;
+    thread_local ThreadMessagePool* t_pool = nullptr;
+
+    struct PoolCloser {
+        ~PoolCloser() {
+            t_pool_state = PoolState::Dead;
+            if (auto* pool = std::exchange(t_pool, nullptr)) {
+                pool->Close();
+            }
+        }
+    };
+
+    thread_local PoolCloser t_pool_closer;
+
+    ThreadMessagePool* LocalPool() {
+        if (t_pool_state == PoolState::Unborn) {
+            // The first use registers the closer's destructor for this thread.
+            (void)&t_pool_closer;
+            t_pool = new ThreadMessagePool();
+            t_pool_state = PoolState::Alive;
+        }
+        return t_pool;
+    }
+}
+
+BroadcastMessagePtr MessagePool::Acquire(const std::string_view payload, const WireProtocol encoding, const std::string_view sender) {
+    ThreadMessagePool* pool = LocalPool();
+    if (!pool) {
+        // The thread is exiting; an ordinary message needs no pool.
+        return MakeBroadcastMessage(std::string(payload), encoding, std::string(sender));
+    }
+
+    if (pool->free_messages.empty() && pool->returned.load(std::memory_order_relaxed)) {
+        pool->CollectReturned();
+    }
+
+    BroadcastMessage* message;
+    if (!pool->free_messages.empty()) {
+        message = pool->free_messages.back();
+        pool->free_messages.pop_back();
+    } else {
+        message = new BroadcastMessage();
+        message->pool_ = pool;
+        pool->references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    message->Assign(payload, encoding, sender);
+    return BroadcastMessagePtr(message);
+}
+
+void MessagePool::Recycle(BroadcastMessage* message) {
+    ThreadMessagePool* owner = message->pool_;
+    if (message->RetainedCapacity() > kMaxPooledCapacity) {
+        owner->Destroy(message);
+    } else if (t_pool_state == PoolState::Alive && owner == t_pool) {
+        owner->Keep(message);
+    } else {
+        owner->Return(message);
+    }
+}
+
+size_t MessagePool::PooledOnThisThread() {
+    return t_pool_state == PoolState::Alive ? t_pool->free_messages.size() : 0;
+}
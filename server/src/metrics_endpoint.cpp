@@ -0,0 +1,204 @@
+#include "../include/metrics_endpoint.h"
+#include "../include/io_engine.h"
+#include "../include/rooms_singleton.h"
+#include "../include/server_metrics.h"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+    struct MetricInfo {
+        const char* name;
+        const char* type;
+        const char* help;
+    };
+
+    constexpr std::array<MetricInfo, ServerMetrics::kMetricCount> kMetrics{{
+        {"chat_accepts_total", "counter", "TCP connections accepted."},
+        {"chat_handshakes_total", "counter", "WebSocket handshakes completed."},
+        {"chat_messages_in_total", "counter", "Chat frames received from clients."},
+        {"chat_messages_out_total", "counter", "Frames written to clients."},
+        {"chat_bytes_in_total", "counter", "Chat payload bytes received from clients."},
+        {"chat_bytes_out_total", "counter", "Bytes written to clients."},
+        {"chat_dropped_sends_total", "counter", "Outbound messages dropped by a full or closed send queue."},
+        {"chat_heartbeat_failures_total", "counter", "Connections closed for missing heartbeats."},
+        {"chat_read_pauses_total", "counter", "Reads paused by an inbound rate limit."},
+        {"chat_open_connections", "gauge", "Live connection objects."},
+        {"chat_queued_messages", "gauge", "Messages waiting in send queues."},
+        {"chat_queued_bytes", "gauge", "Bytes waiting in send queues."}
+    }};
+
+    constexpr std::array<MetricInfo, ServerMetrics::kLatencyMetricCount> kLatencyMetrics{{
+        {"chat_accept_to_handshake_seconds", "histogram", "Time from accept to a completed WebSocket handshake."},
+        {"chat_receive_to_fanout_seconds", "histogram", "Time from reading a chat frame to handing it to all of its recipients."}
+    }};
+
+    void WriteHeader(std::ostream& out, const MetricInfo& info) {
+        out << "# HELP " << info.name << ' ' << info.help << '\n';
+        out << "# TYPE " << info.name << ' ' << info.type << '\n';
+    }
+
+    std::string EscapeLabel(const std::string& value) {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (const char c : value) {
+            switch (c) {
+                case '\\': escaped += "\\\\"; break;
+                case '"': escaped += "\\\""; break;
+                case '\n': escaped += "\\n"; break;
+                default: escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    double ToSeconds(const std::chrono::nanoseconds value) {
+        return std::chrono::duration<double>(value).count();
+    }
+
+    struct Session {
+        explicit Session(ip::tcp::socket&& socket) : stream(std::move(socket)) {}
+
+        tcp_stream stream;
+        flat_buffer buffer;
+        http::request<http::empty_body> request;
+        http::response<http::string_body> response;
+    };
+
+    void Serve(const std::shared_ptr<Session>& session) {
+        session->stream.expires_after(std::chrono::seconds(10));
+        http::async_read(session->stream, session->buffer, session->request,
+            [session](const error_code& ec, std::size_t) {
+                if (ec) return;
+
+                auto& response = session->response;
+                response.version(session->request.version());
+                response.keep_alive(false);
+                response.result(http::status::ok);
+                response.set(http::field::content_type, "text/plain; version=0.0.4");
+                response.body() = MetricsEndpoint::Render();
+                response.prepare_payload();
+
+                http::async_write(session->stream, response,
+                    [session](const error_code&, std::size_t) {
+                        error_code ignored;
+                        session->stream.socket().shutdown(ip::tcp::socket::shutdown_send, ignored);
+                    });
+            });
+    }
+}
+
+MetricsEndpoint::MetricsEndpoint(io_context& io_context, const ip::tcp::endpoint& endpoint)
+    : acceptor_(io_context)
+{
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(ip::tcp::acceptor::reuse_address(true));
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    Stop();
+}
+
+void MetricsEndpoint::Start() {
+    is_accepting_ = true;
+    AsyncAccept();
+}
+
+void MetricsEndpoint::Stop() {
+    is_accepting_ = false;
+    error_code ignored;
+    acceptor_.close(ignored);
+}
+
+void MetricsEndpoint::AsyncAccept() {
+    if (!is_accepting_) return;
+
+    acceptor_.async_accept(
+        [this](const error_code& error, ip::tcp::socket socket) {
+            if (!error) {
+                Serve(std::make_shared<Session>(std::move(socket)));
+            }
+            if (is_accepting_) {
+                AsyncAccept();
+            }
+        });
+}
+
+std::string MetricsEndpoint::Render() {
+    const auto snapshot = ServerMetrics::Collect();
+    std::ostringstream out;
+
+    for (size_t i = 0; i < kMetrics.size(); ++i) {
+        WriteHeader(out, kMetrics[i]);
+        out << kMetrics[i].name << ' ' << snapshot.values[i] << '\n';
+    }
+
+    for (size_t i = 0; i < kLatencyMetrics.size(); ++i) {
+        const auto& info = kLatencyMetrics[i];
+        const auto& histogram = snapshot.latencies[i];
+        WriteHeader(out, info);
+
+        // Prometheus buckets are cumulative.
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < ServerMetrics::kBucketBounds.size(); ++b) {
+            cumulative += histogram.buckets[b];
+            out << info.name << "_bucket{le=\"" << ToSeconds(ServerMetrics::kBucketBounds[b]) << "\"} "
+                << cumulative << '\n';
+        }
+        cumulative += histogram.buckets.back();
+        out << info.name << "_bucket{le=\"+Inf\"} " << cumulative << '\n';
+        out << info.name << "_sum " << ToSeconds(histogram.sum) << '\n';
+        out << info.name << "_count " << cumulative << '\n';
+    }
+
+    auto rooms = RoomsSingleton::GetInstance()->GetAllRooms();
+    WriteHeader(out, {"chat_rooms", "gauge", "Registered rooms."});
+    out << "chat_rooms " << rooms.size() << '\n';
+
+    size_t members = 0;
+    uint64_t distributed = 0;
+    for (const auto& room : rooms) {
+        members += room->ConnectionCount();
+        distributed += room->MessagesDistributed();
+    }
+    WriteHeader(out, {"chat_room_members", "gauge", "Connections across all rooms."});
+    out << "chat_room_members " << members << '\n';
+    WriteHeader(out, {"chat_room_messages_distributed_total", "counter", "Messages distributed across all rooms."});
+    out << "chat_room_messages_distributed_total " << distributed << '\n';
+
+    // Room names come from clients, so only the largest rooms get series of
+    // their own; the totals above cover the rest.
+    const auto largest = rooms.begin() + static_cast<std::ptrdiff_t>(std::min(rooms.size(), kMaxRoomSeries));
+    std::partial_sort(rooms.begin(), largest, rooms.end(), [](const auto& a, const auto& b) {
+        return a->ConnectionCount() > b->ConnectionCount();
+    });
+    rooms.erase(largest, rooms.end());
+
+    WriteHeader(out, {"chat_room_connections", "gauge", "Connections in each of the largest rooms."});
+    for (const auto& room : rooms) {
+        out << "chat_room_connections{room=\"" << EscapeLabel(room->GetName()) << "\"} "
+            << room->ConnectionCount() << '\n';
+    }
+
+    WriteHeader(out, {"chat_room_messages_total", "counter", "Messages distributed in each of the largest rooms."});
+    for (const auto& room : rooms) {
+        out << "chat_room_messages_total{room=\"" << EscapeLabel(room->GetName()) << "\"} "
+            << room->MessagesDistributed() << '\n';
+    }
+
+    // Busy seconds rather than a ratio: rate() over any scrape window gives
+    // the utilization of that window.
+    if (const auto* engine = IoEngine::Active()) {
+        WriteHeader(out, {"chat_io_backend_info", "gauge", "Reactor the server was built with."});
+        out << "chat_io_backend_info{backend=\"" << IoEngine::BackendName() << "\"} 1\n";
+
+        WriteHeader(out, {"chat_io_thread_busy_seconds_total", "counter", "CPU time spent by each io thread."});
+        for (const auto& usage : engine->Usage()) {
+            out << "chat_io_thread_busy_seconds_total{thread=\"" << usage.thread
+                << "\",context=\"" << usage.context << "\"} " << usage.busy_seconds << '\n';
+        }
+    }
+
+    return out.str();
+}
@@ -0,0 +1,91 @@
+#include "../include/outbound_queue.h"
+
+OutboundQueue::OutboundQueue(const size_t max_queued_bytes, const OverflowPolicy overflow_policy)
+    : max_queued_bytes_(max_queued_bytes),
+      overflow_policy_(overflow_policy) {}
+
+OutboundQueue::PushResult OutboundQueue::Push(BroadcastMessagePtr message) {
+    if (closed_) {
+        return PushResult::Dropped;
+    }
+
+    if (!MakeRoom(message->Size())) {
+        return overflow_policy_ == OverflowPolicy::Disconnect
+            ? PushResult::Overflow
+            : PushResult::Dropped;
+    }
+
+    queued_bytes_ += message->Size();
+    pending_.emplace_back(std::move(message));
+
+    if (writing_) {
+        return PushResult::Queued;
+    }
+
+    writing_ = true;
+    return PushResult::StartWrite;
+}
+
+const BroadcastMessage* OutboundQueue::Front() {
+    if (batch_.empty()) {
+        batch_.swap(pending_);
+    }
+    return batch_.empty() ? nullptr : batch_.front().get();
+}
+
+bool OutboundQueue::PopFront() {
+    if (!batch_.empty()) {
+        queued_bytes_ -= batch_.front()->Size();
+        batch_.pop_front();
+    }
+
+    if (batch_.empty() && pending_.empty()) {
+        writing_ = false;
+        return false;
+    }
+    return true;
+}
+
+void OutboundQueue::Close() {
+    closed_ = true;
+    pending_.clear();
+    queued_bytes_ = 0;
+    for (const auto& message : batch_) {
+        queued_bytes_ += message->Size();
+    }
+}
+
+void OutboundQueue::Seal() {
+    // Unlike Close, what is already queued still goes out.
+    closed_ = true;
+}
+
+size_t OutboundQueue::QueuedBytes() const {
+    return queued_bytes_;
+}
+
+size_t OutboundQueue::QueuedMessages() const {
+    return pending_.size() + batch_.size();
+}
+
+bool OutboundQueue::IsWriting() const {
+    return writing_;
+}
+
+bool OutboundQueue::MakeRoom(const size_t payload_size) {
+    if (queued_bytes_ + payload_size <= max_queued_bytes_) {
+        return true;
+    }
+
+    if (overflow_policy_ != OverflowPolicy::DropOldest) {
+        return false;
+    }
+
+    // Only messages not yet handed to the writer can be evicted.
+    while (!pending_.empty() && queued_bytes_ + payload_size > max_queued_bytes_) {
+        queued_bytes_ -= pending_.front()->Size();
+        pending_.pop_front();
+    }
+
+    return queued_bytes_ + payload_size <= max_queued_bytes_;
+}
@@ -1,62 +1,226 @@
 #include "../include/room.h"
 #include "../include/rooms_singleton.h"
 #include "../include/socket_connection.h"
+#include "../include/server_metrics.h"
+#include "../include/history_log.h"
 #include <boost/thread/lock_guard.hpp>
+#include <algorithm>
 #include <chrono>
 
-Room::Room(std::string room_name)
-    : room_identifier_(std::move(room_name)) {}
+namespace {
+    constexpr size_t kMinCompactThreshold = 64;
+    constexpr uint32_t kNoPosition = std::numeric_limits<uint32_t>::max();
+}
 
-void Room::AddConnection(boost::weak_ptr<SocketConnection> connection) {
+Room::Room(std::string room_name, const RoomOptions options)
+    : compact_threshold_(kMinCompactThreshold),
+      message_history_(options.history),
+      room_identifier_(std::move(room_name)),
+      delivery_shard_(DeliveryExecutor::GetInstance().ShardFor(room_identifier_)),
+      inbound_messages_(options.inbound.messages),
+      inbound_bytes_(options.inbound.bytes)
+{
+    if (options.batch.window.count() > 0) {
+        batcher_ = boost::make_shared<BroadcastBatcher>(delivery_shard_, options.batch);
+    }
+}
+
+Room::MemberHandle Room::AddConnection(boost::weak_ptr<SocketConnection> connection) {
     boost::lock_guard guard(room_mutex_);
-    connections_.emplace_back(std::move(connection));
+
+    // Sweeping only when the vector has doubled since the last sweep keeps
+    // the cost amortized O(1) per join.
+    if (members_.size() >= compact_threshold_) {
+        CompactExpiredMembers();
+        compact_threshold_ = std::max(kMinCompactThreshold, members_.size() * 2);
+    }
+
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(member_slots_.size());
+        member_slots_.push_back({kNoPosition, 0});
+    }
+
+    member_slots_[slot].position = static_cast<uint32_t>(members_.size());
+    members_.push_back(Member{std::move(connection), slot});
+    member_snapshot_.store(nullptr);
+    return static_cast<MemberHandle>(member_slots_[slot].generation) << 32 | slot;
+}
+
+void Room::RemoveConnection(const MemberHandle handle) {
+    boost::lock_guard guard(room_mutex_);
+
+    const auto slot = static_cast<uint32_t>(handle);
+    const auto generation = static_cast<uint32_t>(handle >> 32);
+    if (slot >= member_slots_.size()
+        || member_slots_[slot].generation != generation
+        || member_slots_[slot].position == kNoPosition) {
+        return;
+    }
+    EraseMemberAt(member_slots_[slot].position);
+    UnregisterIfEmpty();
 }
 
 void Room::RemoveConnection(const boost::weak_ptr<SocketConnection> &connection) {
     boost::lock_guard guard(room_mutex_);
 
-    std::erase_if(
-        connections_,
-        [&](const auto& conn) {
-            auto locked = connection.lock();
-            auto current = conn.lock();
-            return !current || (locked && current == locked);
+    // For callers without a handle: a linear scan comparing control blocks,
+    // which needs no weak_ptr locking. Expired members go in the same pass.
+    for (size_t i = members_.size(); i-- > 0;) {
+        const auto& member = members_[i].connection;
+        const bool same = !connection.owner_before(member) && !member.owner_before(connection);
+        if (member.expired() || same) {
+            EraseMemberAt(i);
         }
-    );
+    }
+    UnregisterIfEmpty();
+}
+
+void Room::EraseMemberAt(const size_t position) {
+    const uint32_t slot = members_[position].slot;
+
+    if (position + 1 != members_.size()) {
+        members_[position] = std::move(members_.back());
+        member_slots_[members_[position].slot].position = static_cast<uint32_t>(position);
+    }
+    members_.pop_back();
+
+    // The next member given this slot gets a new generation, so handles to
+    // the old one stop matching.
+    member_slots_[slot] = {kNoPosition, member_slots_[slot].generation + 1};
+    free_slots_.push_back(slot);
+    member_snapshot_.store(nullptr);
+}
+
+boost::shared_ptr<const Room::MemberList> Room::MemberSnapshot() const {
+    if (auto snapshot = member_snapshot_.load()) {
+        return snapshot;
+    }
+
+    boost::lock_guard guard(room_mutex_);
+    if (auto snapshot = member_snapshot_.load()) {
+        return snapshot;
+    }
+
+    auto members = boost::make_shared<MemberList>();
+    members->reserve(members_.size());
+    for (const auto& member : members_) {
+        members->push_back(member.connection);
+    }
+
+    boost::shared_ptr<const MemberList> snapshot = std::move(members);
+    member_snapshot_.store(snapshot);
+    return snapshot;
+}
+
+void Room::CompactExpiredMembers() {
+    for (size_t i = members_.size(); i-- > 0;) {
+        if (members_[i].connection.expired()) {
+            EraseMemberAt(i);
+        }
+    }
+}
 
-    if (connections_.empty()) {
-        post([this] {
-            RoomsSingleton::GetInstance()->UnregisterRoom(room_identifier_);
+void Room::UnregisterIfEmpty() const {
+    if (members_.empty()) {
+        // Capture the name, not the room: the task may outlive this object.
+        post(delivery_shard_, [name = room_identifier_] {
+            RoomsSingleton::GetInstance()->UnregisterRoom(name);
         });
     }
 }
 
 void Room::DistributeMessage(const std::string& content) {
+    DistributeMessage(MakeBroadcastMessage(content));
+}
 
-    boost::lock_guard guard(room_mutex_);
-    message_history_.emplace_back(content);
+void Room::DistributeMessage(const BroadcastMessagePtr& message) {
+    const auto members = MemberSnapshot();
+    ++messages_distributed_;
 
-    for (auto& conn : connections_) {
-        post(
-            delivery_pool_,
-            [content, conn] {
-                ProcessMessageDelivery(content, conn);
+    // Appending and posting under one short lock keeps the delivery order
+    // equal to the history order; the fan-out itself runs on the strand.
+    boost::lock_guard guard(distribute_mutex_);
+    message_history_.Append(message);
+    if (auto* log = HistoryLog::Active()) {
+        log->Append(room_identifier_, *message);
+    }
+
+    if (batcher_) {
+        batcher_->Add(message, std::move(members));
+        return;
+    }
+
+    post(
+        delivery_shard_,
+        [message, members] {
+            for (const auto& connection : *members) {
+                ProcessMessageDelivery(message, connection);
             }
-        );
+
+            // One clock read per broadcast, not per recipient.
+            if (const auto received_at = message->ReceivedAt(); received_at != std::chrono::steady_clock::time_point{}) {
+                ServerMetrics::Observe(LatencyMetric::ReceiveToFanout, std::chrono::steady_clock::now() - received_at);
+            }
+        }
+    );
+}
+
+void Room::RestoreHistory(const std::vector<BroadcastMessagePtr>& messages) {
+    boost::lock_guard guard(distribute_mutex_);
+    for (const auto& message : messages) {
+        message_history_.Append(message);
     }
 }
 
+TokenBucket::Clock::duration Room::ChargeInbound(const size_t bytes, const TokenBucket::Clock::time_point now) {
+    return std::max(
+        inbound_messages_.Charge(1, now),
+        inbound_bytes_.Charge(static_cast<double>(bytes), now)
+    );
+}
+
 std::vector<std::string> Room::GetMessageHistory() const {
-    boost::lock_guard guard(room_mutex_);
-    return message_history_;
+    const auto slice = message_history_.Tail(message_history_.Size());
+
+    std::vector<std::string> history;
+    history.reserve(slice.size());
+    for (const auto& entry : slice) {
+        history.emplace_back(entry.message->Data());
+    }
+    return history;
+}
+
+HistorySlice Room::GetRecentHistory(const size_t count) const {
+    return message_history_.Tail(count);
+}
+
+HistorySlice Room::GetHistoryPage(const uint64_t after_sequence, const size_t limit) const {
+    return message_history_.Page(after_sequence, limit);
+}
+
+const std::string& Room::GetName() const {
+    return room_identifier_;
+}
+
+size_t Room::ConnectionCount() const {
+    return MemberSnapshot()->size();
+}
+
+uint64_t Room::MessagesDistributed() const {
+    return messages_distributed_.load(boost::memory_order_relaxed);
 }
 
 std::vector<std::string> Room::GetActiveUsers() const {
-    std::vector<std::string> users;
-    boost::lock_guard guard(room_mutex_);
+    const auto members = MemberSnapshot();
 
-    for (const auto& conn : connections_) {
-        if (const auto connection = conn.lock()) {
+    std::vector<std::string> users;
+    users.reserve(members->size());
+    for (const auto& member : *members) {
+        if (const auto connection = member.lock()) {
             users.emplace_back(connection->GetUserIdentifier());
         }
     }
@@ -65,10 +229,10 @@ std::vector<std::string> Room::GetActiveUsers() const {
 }
 
 auto Room::ProcessMessageDelivery(
-    const std::string &formatted_message,
+    const BroadcastMessagePtr &message,
     const boost::weak_ptr<SocketConnection> &connection
 ) -> void {
     if (const auto conn = connection.lock()) {
-        conn->TransmitData(formatted_message);
+        conn->TransmitData(message);
     }
 }
\ No newline at end of file
@@ -1,14 +1,14 @@
 #include "../include/rooms_singleton.h"
-
-boost::shared_ptr<RoomsSingleton> RoomsSingleton::instance_;
-boost::mutex RoomsSingleton::instance_mutex_;
+#include "../include/delivery_executor.h"
+#include "../include/socket_connection.h"
+#include <functional>
 
 boost::shared_ptr<RoomsSingleton> RoomsSingleton::GetInstance() {
-    boost::lock_guard lock(instance_mutex_);
-    if (!instance_) {
-        instance_.reset(new RoomsSingleton());
-    }
-    return instance_;
+    // Initialized once under the compiler's static-init guard; later calls
+    // are a plain load. Never destroyed, so connections released during
+    // static destruction can still unregister themselves.
+    static const auto* instance = new boost::shared_ptr<RoomsSingleton>(new RoomsSingleton());
+    return *instance;
 }
 
 void RoomsSingleton::ValidateName(const std::string& name) {
@@ -17,45 +17,179 @@ void RoomsSingleton::ValidateName(const std::string& name) {
     }
 }
 
+RoomsSingleton::Shard& RoomsSingleton::ShardFor(const std::string& name) {
+    return shards_[std::hash<std::string>{}(name) % kShardCount];
+}
+
+const RoomsSingleton::Shard& RoomsSingleton::ShardFor(const std::string& name) const {
+    return shards_[std::hash<std::string>{}(name) % kShardCount];
+}
+
 void RoomsSingleton::RegisterRoom(const std::string& name, boost::shared_ptr<Room> room) {
     ValidateName(name);
-    boost::unique_lock lock(rooms_mutex_);
+    auto& shard = ShardFor(name);
+    boost::lock_guard lock(shard.write_mutex);
 
-    if (rooms_.contains(name)) {
+    const auto current = shard.rooms.load();
+    if (current->contains(name)) {
         throw std::runtime_error("Room already exists: " + name);
     }
-    rooms_.emplace(name, std::move(room));
+
+    auto next = boost::make_shared<RoomMap>(*current);
+    next->emplace(name, std::move(room));
+    shard.rooms.store(std::move(next));
+    ++room_count_;
+
+    PublishChange(true, name);
 }
 
 void RoomsSingleton::UnregisterRoom(const std::string& name) {
     ValidateName(name);
-    boost::unique_lock lock(rooms_mutex_);
-    rooms_.erase(name);
+    auto& shard = ShardFor(name);
+    boost::lock_guard lock(shard.write_mutex);
+
+    const auto current = shard.rooms.load();
+    if (!current->contains(name)) {
+        return;
+    }
+
+    auto next = boost::make_shared<RoomMap>(*current);
+    next->erase(name);
+    shard.rooms.store(std::move(next));
+    --room_count_;
+
+    PublishChange(false, name);
 }
 
 boost::shared_ptr<Room> RoomsSingleton::FetchRoom(const std::string& name) const {
     ValidateName(name);
-    boost::shared_lock lock(rooms_mutex_);
+    const auto rooms = ShardFor(name).rooms.load();
 
-    const auto it = rooms_.find(name);
-    if (it == rooms_.end()) {
+    const auto it = rooms->find(name);
+    if (it == rooms->end()) {
         throw std::out_of_range("Room not found: " + name);
     }
     return it->second;
 }
 
 std::vector<std::string> RoomsSingleton::GetAllRoomNames() const {
-    boost::shared_lock lock(rooms_mutex_);
-
     std::vector<std::string> names;
-    names.reserve(rooms_.size());
-    for (const auto& pair : rooms_) {
-        names.push_back(pair.first);
+    names.reserve(room_count_.load(boost::memory_order_relaxed));
+
+    for (const auto& shard : shards_) {
+        const auto rooms = shard.rooms.load();
+        for (const auto& pair : *rooms) {
+            names.push_back(pair.first);
+        }
     }
     return names;
 }
 
+std::vector<boost::shared_ptr<Room>> RoomsSingleton::GetAllRooms() const {
+    std::vector<boost::shared_ptr<Room>> rooms;
+    rooms.reserve(room_count_.load(boost::memory_order_relaxed));
+
+    for (const auto& shard : shards_) {
+        const auto snapshot = shard.rooms.load();
+        for (const auto& pair : *snapshot) {
+            rooms.push_back(pair.second);
+        }
+    }
+    return rooms;
+}
+
+size_t RoomsSingleton::RoomCount() const {
+    return room_count_.load(boost::memory_order_relaxed);
+}
+
 void RoomsSingleton::PurgeAllRooms() {
-    boost::unique_lock lock(rooms_mutex_);
-    rooms_.clear();
-}
\ No newline at end of file
+    for (auto& shard : shards_) {
+        boost::lock_guard lock(shard.write_mutex);
+        room_count_ -= shard.rooms.load()->size();
+        shard.rooms.store(boost::make_shared<const RoomMap>());
+    }
+    ++version_;
+}
+
+uint64_t RoomsSingleton::Version() const {
+    return version_.load();
+}
+
+RoomListSnapshot RoomsSingleton::GetRoomListSnapshot() {
+    if (const auto cached = room_list_.load(); cached && cached->version == version_.load()) {
+        return *cached;
+    }
+
+    boost::lock_guard lock(room_list_mutex_);
+
+    // Read the version before the names: the listing is then at least as new
+    // as the version it is tagged with, and later deltas are idempotent.
+    const uint64_t version = version_.load();
+    if (const auto cached = room_list_.load(); cached && cached->version == version) {
+        return *cached;
+    }
+
+    const auto names = GetAllRoomNames();
+    const nlohmann::json response{{"rooms", names}, {"version", version}};
+    const auto snapshot = boost::make_shared<const RoomListSnapshot>(
+        RoomListSnapshot{
+            version,
+            MakeDualEncodedMessage(
+                response.dump(),
+                WireCodec::EncodeRoomList(version, names)
+            )
+        }
+    );
+    room_list_.store(snapshot);
+    return *snapshot;
+}
+
+void RoomsSingleton::SubscribeLobby(const boost::shared_ptr<SocketConnection>& connection) {
+    boost::lock_guard lock(lobby_mutex_);
+    auto next = boost::make_shared<LobbyMap>(*lobby_.load());
+    next->emplace(connection.get(), connection);
+    lobby_.store(std::move(next));
+}
+
+void RoomsSingleton::UnsubscribeLobby(const SocketConnection* connection) {
+    boost::lock_guard lock(lobby_mutex_);
+    const auto current = lobby_.load();
+    if (!current->contains(connection)) {
+        return;
+    }
+
+    auto next = boost::make_shared<LobbyMap>(*current);
+    next->erase(connection);
+    lobby_.store(std::move(next));
+}
+
+void RoomsSingleton::PublishChange(const bool added, const std::string& name) {
+    boost::lock_guard lock(publish_mutex_);
+    const uint64_t version = ++version_;
+
+    // Loaded after the version bump: a connection missing from this snapshot
+    // subscribed late enough to read a listing that already has the change.
+    auto subscribers = lobby_.load();
+    if (subscribers->empty()) {
+        return;
+    }
+
+    const nlohmann::json delta{{added ? "roomAdded" : "roomRemoved", name}, {"version", version}};
+    const auto message = MakeDualEncodedMessage(
+        delta.dump(),
+        WireCodec::EncodeRoomListDelta(added, version, name)
+    );
+
+    // Posting under publish_mutex_ to a single strand keeps deltas in version
+    // order. The snapshot is walked there, outside any lock.
+    post(
+        DeliveryExecutor::GetInstance().ShardFor("lobby"),
+        [message, subscribers = std::move(subscribers)] {
+            for (const auto& [key, subscriber] : *subscribers) {
+                if (const auto connection = subscriber.lock()) {
+                    connection->TransmitData(message);
+                }
+            }
+        }
+    );
+}
@@ -1,146 +1,388 @@
 #include "../include/server_controller.h"
 #include "../include/connection_acceptor.h"
-#include <csignal>
+#include "../include/io_engine.h"
+#include "../include/metrics_endpoint.h"
+#include "../include/history_log.h"
+#include "../include/rooms_singleton.h"
+#include "../include/graceful_shutdown.h"
+#include "../include/connection_registry.h"
+#include "../include/slab_allocator.h"
+#include "../include/logger.h"
+#include <future>
 #include <iostream>
-#include <thread>
+#include <limits>
+#include <memory>
+#include <string>
 #include <vector>
 
-boost::atomic<bool> ServerController::g_force_exit{false};
+namespace {
+    void Log(const LogLevel level, const std::string_view message, const std::initializer_list<LogField> fields = {}) {
+        Logger::GetInstance().Log(level, message, fields);
+    }
+
+    // Parses the value of "--name=N" into target if it lies in [min, max].
+    bool ParseBoundedInt(const std::string& arg, const std::string& prefix, const int min, const int max, int& target) {
+        try {
+            if (const int value = std::stoi(arg.substr(prefix.size())); value >= min && value <= max) {
+                target = value;
+                return true;
+            }
+        } catch (const std::exception&) {}
+
+        std::cerr << "Invalid value in '" << arg << "', expected " << min << ".." << max << std::endl;
+        return false;
+    }
+
+    // A rate limit of zero turns the limit off; the burst is one second's worth.
+    bool ParseRate(const std::string& arg, const std::string& prefix, RateLimit& target) {
+        int rate = 0;
+        if (!ParseBoundedInt(arg, prefix, 0, std::numeric_limits<int>::max(), rate)) return false;
+        target.per_second = rate;
+        return true;
+    }
+}
 
 int ServerController::RunService(int argc, char** argv) {
-    if (!ValidateArguments(argc, argv)) return 1;
+    ServerOptions options;
+    if (!ParseArguments(argc, argv, options)) return 1;
+
+    Logger::GetInstance().SetLevel(options.log_level);
 
     try {
-        std::cout << "Starting server..." << std::endl;
-
-        const char* port = argv[1];
-
-        size_t num_threads = 4;
-        if (argc >= 3) {
-            try {
-                if (const int threads = std::stoi(argv[2]); threads > 0) {
-                    num_threads = static_cast<size_t>(threads);
-                } else {
-                    std::cerr << "Warning: Invalid thread count '" << argv[2]
-                              << "', using default (4)" << std::endl;
-                }
-            } catch (const std::exception& e) {
-                std::cerr << "Warning: Failed to parse thread count '" << argv[2]
-                          << "', using default (4)" << std::endl;
-            }
+        Log(LogLevel::Info, "Starting server", {{"threads", options.io.threads}});
+
+        const auto history = InitializeHistoryLog(options);
+
+        RunEngine(options);
+
+        if (history) {
+            HistoryLog::SetActive(nullptr);
+            history->Flush();
+            Log(LogLevel::Info, "History log closed", {{"written", history->Written()}, {"dropped", history->Dropped()}});
         }
 
-        std::cout << "Using " << num_threads << " threads for server" << std::endl;
+        Log(LogLevel::Info, "Server stopped");
+        PrintAllocatorStats();
+
+    } catch (const std::exception& e) {
+        Log(LogLevel::Error, "Fatal error", {{"detail", e.what()}});
+        Logger::GetInstance().Flush();
+        return 2;
+    }
+    Logger::GetInstance().Flush();
+    return 0;
+}
+
+void ServerController::RunEngine(const ServerOptions& options) {
+    IoEngine engine(options.io);
+
+    // Shared mode has one acceptor on the single io_context; per-core mode
+    // gives every io_context its own SO_REUSEPORT acceptor, so a connection
+    // is accepted and served on the same thread.
+    std::vector<boost::shared_ptr<ConnectionAcceptor>> listeners;
+    for (size_t i = 0; i < engine.ContextCount(); ++i) {
+        listeners.push_back(InitializeNetworkComponents(engine.Context(i), options));
+    }
+
+    // The admin endpoint shares the first reactor; scrapes are rare and short.
+    const auto metrics = InitializeMetricsEndpoint(engine.Context(0), options);
+
+    engine.Start();
+    IoEngine::SetActive(&engine);
+    Log(LogLevel::Info, "Server started", {
+        {"port", options.port},
+        {"io_backend", IoEngine::BackendName()},
+        {"io_threads", engine.ThreadCount()},
+        {"io_contexts", engine.ContextCount()}
+    });
+
+    AwaitShutdown(listeners, options.shutdown);
+
+    if (metrics) metrics->Stop();
+    IoEngine::SetActive(nullptr);
+    PrintThreadUsage(engine);
 
-        io_context io_ctx;
-        auto work = boost::asio::make_work_guard(io_ctx);
+    Log(LogLevel::Info, "Stopping io_contexts");
+    engine.Stop();
+
+    for (const auto& listener : listeners) {
+        listener->Stop();
+    }
+}
 
-        SetupSignalHandling();
+void ServerController::PrintThreadUsage(const IoEngine& engine) {
+    for (const auto& usage : engine.Usage()) {
+        Log(LogLevel::Info, "io thread usage", {
+            {"thread", usage.thread},
+            {"context", usage.context},
+            {"cpu", usage.cpu},
+            {"busy_s", usage.busy_seconds},
+            {"utilization", usage.Utilization()}
+        });
+    }
+}
 
-        InitializeNetworkComponents(io_ctx, port, num_threads);
+void ServerController::PrintAllocatorStats() {
+    if (!SlabAllocator::Enabled()) return;
 
-        std::cout << "Server started on port " << port << std::endl;
-        std::cout.flush();
+    const auto stats = SlabAllocator::GetStats();
+    Log(LogLevel::Info, "Slab allocator stats", {
+        {"hits", stats.hits},
+        {"misses", stats.misses},
+        {"oversized", stats.oversized},
+        {"hit_rate", stats.HitRate()}
+    });
+}
 
-        std::vector<std::thread> threads;
-        std::cout << "Creating " << num_threads << " io_context threads" << std::endl;
+void ServerController::AwaitShutdown(
+    const std::vector<boost::shared_ptr<ConnectionAcceptor>>& listeners,
+    const ShutdownOptions& options
+) {
+    // The calling thread sleeps in control.run() until the drain finishes;
+    // a second signal cuts the drain short.
+    io_context control(1);
+    boost::asio::signal_set signals(control, SIGINT, SIGTERM);
 
-        for(size_t i = 0; i < num_threads; ++i) {
-            threads.emplace_back([&io_ctx, i] {
-                try {
-                    io_ctx.run();
-                } catch (const std::exception& e) {
-                    std::cerr << "Thread " << i << " exception: " << e.what() << std::endl;
-                }
+    const auto shutdown = boost::make_shared<GracefulShutdown>(
+        control,
+        options,
+        [&signals](const bool drained) {
+            Log(drained ? LogLevel::Info : LogLevel::Warn, "Drain finished", {
+                {"drained", drained ? "true" : "false"},
+                {"remaining", ConnectionRegistry::GetInstance().Size()}
             });
+            signals.cancel();
         }
+    );
+
+    signals.async_wait([&](const error_code& ec, const int signal_number) {
+        if (ec) return;
+        Log(LogLevel::Info, "Exit signal received, draining connections", {
+            {"signal", signal_number},
+            {"connections", ConnectionRegistry::GetInstance().Size()}
+        });
 
-        std::cout << "Main thread waiting for exit signal" << std::endl;
-        while(!g_force_exit.load()) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+        // Stop every acceptor on its own io_context before taking the list
+        // of connections, so nothing accepted later is missed.
+        for (const auto& listener : listeners) {
+            std::promise<void> stopped;
+            post(listener->GetContext(), [&] {
+                listener->StopAccepting();
+                stopped.set_value();
+            });
+            stopped.get_future().wait();
         }
 
-        std::cout << "Stopping io_context..." << std::endl;
-        io_ctx.stop();
+        signals.async_wait([&](const error_code& second_ec, int) {
+            if (second_ec) return;
+            Log(LogLevel::Warn, "Second exit signal received, stopping now");
+            shutdown->Abort();
+        });
+        shutdown->Start();
+    });
 
-        std::cout << "Joining threads..." << std::endl;
-        for(auto& t : threads) {
-            if(t.joinable()) {
-                t.join();
-            }
+    control.run();
+}
+
+bool ServerController::ParseArguments(int arg_count, char** arg_values, ServerOptions& options) {
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < arg_count; ++i) {
+        const std::string arg = arg_values[i];
+
+        if (arg == "--io-mode=shared") {
+            options.io.mode = IoMode::Shared;
+        } else if (arg == "--io-mode=per-core") {
+            options.io.mode = IoMode::PerCore;
+        } else if (arg == "--pin-cpus") {
+            options.io.pin_cpus = true;
+        } else if (arg.starts_with("--admin-port=")) {
+            options.admin_port = arg.substr(std::string("--admin-port=").size());
+        } else if (arg.starts_with("--admin-address=")) {
+            options.admin_address = arg.substr(std::string("--admin-address=").size());
+        } else if (arg == "--log-level=debug") {
+            options.log_level = LogLevel::Debug;
+        } else if (arg == "--log-level=info") {
+            options.log_level = LogLevel::Info;
+        } else if (arg == "--log-level=warn") {
+            options.log_level = LogLevel::Warn;
+        } else if (arg == "--log-level=error") {
+            options.log_level = LogLevel::Error;
+        } else if (arg == "--deflate") {
+            options.deflate.enabled = true;
+        } else if (arg.starts_with("--deflate-window-bits=")) {
+            // zlib rejects a raw deflate window of 8 bits.
+            if (!ParseBoundedInt(arg, "--deflate-window-bits=", 9, 15, options.deflate.window_bits)) return false;
+        } else if (arg.starts_with("--deflate-mem-level=")) {
+            if (!ParseBoundedInt(arg, "--deflate-mem-level=", 1, 9, options.deflate.mem_level)) return false;
+        } else if (arg.starts_with("--drain-timeout-ms=")) {
+            int timeout = 0;
+            if (!ParseBoundedInt(arg, "--drain-timeout-ms=", 0, 600000, timeout)) return false;
+            options.shutdown.drain_timeout = std::chrono::milliseconds(timeout);
+        } else if (arg.starts_with("--close-batch=")) {
+            int batch = 0;
+            if (!ParseBoundedInt(arg, "--close-batch=", 1, 1000000, batch)) return false;
+            options.shutdown.close_batch = static_cast<size_t>(batch);
+        } else if (arg.starts_with("--max-msgs-per-sec=")) {
+            if (!ParseRate(arg, "--max-msgs-per-sec=", options.connection_limits.messages)) return false;
+        } else if (arg.starts_with("--max-bytes-per-sec=")) {
+            if (!ParseRate(arg, "--max-bytes-per-sec=", options.connection_limits.bytes)) return false;
+        } else if (arg.starts_with("--room-max-msgs-per-sec=")) {
+            if (!ParseRate(arg, "--room-max-msgs-per-sec=", options.room.inbound.messages)) return false;
+        } else if (arg.starts_with("--room-max-bytes-per-sec=")) {
+            if (!ParseRate(arg, "--room-max-bytes-per-sec=", options.room.inbound.bytes)) return false;
+        } else if (arg.starts_with("--batch-window-us=")) {
+            int window = 0;
+            if (!ParseBoundedInt(arg, "--batch-window-us=", 0, 1000000, window)) return false;
+            options.room.batch.window = std::chrono::microseconds(window);
+        } else if (arg.starts_with("--batch-max-bytes=")) {
+            int bytes = 0;
+            if (!ParseBoundedInt(arg, "--batch-max-bytes=", 1, 64 * 1024 * 1024, bytes)) return false;
+            options.room.batch.max_bytes = static_cast<size_t>(bytes);
+        } else if (arg.starts_with("--history-dir=")) {
+            options.history_dir = arg.substr(std::string("--history-dir=").size());
+        } else if (arg.starts_with("--")) {
+            std::cerr << "Unknown option '" << arg << "'" << std::endl;
+            PrintUsage(arg_values[0]);
+            return false;
+        } else {
+            positional.push_back(arg);
         }
+    }
 
-        std::cout << "Server stopped" << std::endl;
+    if (positional.empty() || positional.size() > 2) {
+        PrintUsage(arg_values[0]);
+        return false;
+    }
 
-    } catch (const std::exception& e) {
-        std::cerr << "Fatal error: " << e.what() << std::endl;
-        return 2;
+    options.port = positional[0];
+
+    if (positional.size() == 2) {
+        try {
+            if (const int threads = std::stoi(positional[1]); threads > 0) {
+                options.io.threads = static_cast<size_t>(threads);
+            } else {
+                std::cerr << "Warning: Invalid thread count '" << positional[1]
+                          << "', using default (4)" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Failed to parse thread count '" << positional[1]
+                      << "', using default (4)" << std::endl;
+        }
     }
-    return 0;
-}
 
-void ServerController::ThreadPoolWrapper::WaitForCompletion() {
-    pool_.join();
+    return true;
 }
 
-bool ServerController::ValidateArguments(int arg_count, char** arg_values) {
-    if (arg_count >= 2 && arg_count <= 3) return true;
-
-    std::cerr << "Execution format: " << arg_values[0]
-              << " <port_number> [thread_count]" << std::endl;
+void ServerController::PrintUsage(const char* program) {
+    std::cerr << "Execution format: " << program
+              << " <port_number> [thread_count] [options]" << std::endl;
     std::cerr << "  port_number  - Port to listen on (required)" << std::endl;
-    std::cerr << "  thread_count - Number of worker threads (optional, default: 4)" << std::endl;
-    return false;
+    std::cerr << "  thread_count - Number of io threads; the server starts no others (optional, default: 4)" << std::endl;
+    std::cerr << "  --io-mode=shared|per-core - One io_context for all threads, or one" << std::endl;
+    std::cerr << "                 io_context and SO_REUSEPORT acceptor per thread (default: shared)" << std::endl;
+    std::cerr << "  --pin-cpus   - Pin io thread N to CPU N modulo the core count" << std::endl;
+    std::cerr << "  --admin-port=PORT - Serve Prometheus metrics on this port (default: off)" << std::endl;
+    std::cerr << "  --admin-address=ADDR - Address the metrics port binds to (default: 127.0.0.1)" << std::endl;
+    std::cerr << "  --log-level=debug|info|warn|error - Minimum level written to the log (default: info)" << std::endl;
+    std::cerr << "  --deflate    - Offer permessage-deflate compression to clients (default: off)" << std::endl;
+    std::cerr << "  --deflate-window-bits=9..15 - Largest compression window to negotiate (default: 15)" << std::endl;
+    std::cerr << "  --deflate-mem-level=1..9 - zlib memory level per connection (default: 4)" << std::endl;
+    std::cerr << "  --drain-timeout-ms=N - Time allowed for connections to drain on shutdown (default: 10000)" << std::endl;
+    std::cerr << "  --close-batch=N - Close frames sent per batch while draining (default: 256)" << std::endl;
+    std::cerr << "  --max-msgs-per-sec=N - Messages one connection may send per second (default: 0, unlimited)" << std::endl;
+    std::cerr << "  --max-bytes-per-sec=N - Message bytes one connection may send per second (default: 0, unlimited)" << std::endl;
+    std::cerr << "  --room-max-msgs-per-sec=N - Messages all members of a room may send per second (default: 0, unlimited)" << std::endl;
+    std::cerr << "  --room-max-bytes-per-sec=N - Message bytes all members of a room may send per second (default: 0, unlimited)" << std::endl;
+    std::cerr << "  --batch-window-us=N - Pack room broadcasts arriving within N microseconds into one frame (default: 0, off)" << std::endl;
+    std::cerr << "  --batch-max-bytes=N - Send a batch early once it holds this many bytes (default: 65536)" << std::endl;
+    std::cerr << "  --history-dir=PATH - Persist room messages here; a room created again gets its history back (default: off)" << std::endl;
 }
 
-void ServerController::InitializeNetworkComponents(
+boost::shared_ptr<ConnectionAcceptor> ServerController::InitializeNetworkComponents(
     io_context& ctx,
-    const char* port,
-    size_t thread_count
+    const ServerOptions& options
 ) {
     try {
-        std::cout << "Creating connection acceptor on port " << port << std::endl;
 
-        static auto listener = boost::make_shared<ConnectionAcceptor>(
+        auto listener = boost::make_shared<ConnectionAcceptor>(
             ctx,
             boost::asio::ip::tcp::endpoint(
                 boost::asio::ip::tcp::v4(),
-                std::stoi(port)
+                std::stoi(options.port)
             ),
-            thread_count
+            options.io.mode == IoMode::PerCore,
+            ConnectionOptions{
+                .deflate = options.deflate,
+                .inbound = options.connection_limits,
+                .room = options.room
+            }
         );
 
-        std::cout << "Starting connection acceptor..." << std::endl;
         listener->Start();
-        std::cout << "Connection acceptor started successfully" << std::endl;
+        return listener;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error initializing network components: " << e.what() << std::endl;
+        Log(LogLevel::Error, "Error initializing network components", {{"detail", e.what()}});
         throw;
     }
 }
 
-void ServerController::SetupSignalHandling() {
-    std::cout << "Setting up signal handlers..." << std::endl;
-    signal(SIGINT, [](int) {
-        std::cout << "Received SIGINT, shutting down..." << std::endl;
-        g_force_exit.store(true);
-    });
+boost::shared_ptr<MetricsEndpoint> ServerController::InitializeMetricsEndpoint(
+    io_context& ctx,
+    const ServerOptions& options
+) {
+    if (options.admin_port.empty()) {
+        return nullptr;
+    }
 
-    signal(SIGTERM, [](int) {
-        std::cout << "Received SIGTERM, shutting down..." << std::endl;
-        g_force_exit.store(true);
-    });
-    std::cout << "Signal handlers set up" << std::endl;
+    try {
+        auto endpoint = boost::make_shared<MetricsEndpoint>(
+            ctx,
+            boost::asio::ip::tcp::endpoint(
+                boost::asio::ip::make_address(options.admin_address),
+                std::stoi(options.admin_port)
+            )
+        );
+        endpoint->Start();
+        Log(LogLevel::Info, "Metrics endpoint listening", {{"address", options.admin_address}, {"port", options.admin_port}});
+        return endpoint;
+    }
+    catch (const std::exception& e) {
+        Log(LogLevel::Error, "Error initializing metrics endpoint", {{"detail", e.what()}});
+        throw;
+    }
 }
 
-ServerController::ThreadPoolWrapper::ThreadPoolWrapper(const size_t threads)
-    : pool_(threads) {}
+std::unique_ptr<HistoryLog> ServerController::InitializeHistoryLog(const ServerOptions& options) {
+    if (options.history_dir.empty()) {
+        return nullptr;
+    }
+
+    try {
+        const auto started = std::chrono::steady_clock::now();
+        auto rooms = HistoryLog::Replay(options.history_dir, options.room.history.max_messages);
 
-void ServerController::ThreadPoolWrapper::Submit(io_context& ctx) {
-    boost::asio::post(pool_, [&ctx] { ctx.run(); });
-}
+        size_t messages = 0;
+        for (const auto& recovered : rooms) {
+            messages += recovered.messages.size();
+        }
+
+        Log(LogLevel::Info, "Room history replayed from history log", {
+            {"rooms", rooms.size()},
+            {"messages", messages},
+            {"ms", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count()}
+        });
 
-ServerController::ThreadPoolWrapper::~ThreadPoolWrapper() {
-    pool_.join();
-}
\ No newline at end of file
+        // Rooms are not registered here; each takes its history when a
+        // client creates it again.
+        auto log = std::make_unique<HistoryLog>(HistoryLogOptions{.directory = options.history_dir});
+        log->Stage(std::move(rooms));
+        HistoryLog::SetActive(log.get());
+        return log;
+    }
+    catch (const std::exception& e) {
+        Log(LogLevel::Error, "Error initializing history log", {{"detail", e.what()}});
+        throw;
+    }
+}
@@ -0,0 +1,120 @@
+#include "../include/server_metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace {
+    struct ThreadMetrics;
+
+    struct Registry {
+        boost::mutex mutex;
+        std::vector<const ThreadMetrics*> live;
+        ServerMetrics::Snapshot retired;
+    };
+
+    Registry& GetRegistry() {
+        // Leaked. The delivery shard threads are joined by a static
+        // destructor, and each one folds its counters into `retired` as it
+        // exits, after this file's statics may already be gone.
+        static auto* registry = new Registry();
+        return *registry;
+    }
+
+    // Trivially destructible, so updates made while the thread is being torn
+    // down can see that its slots are gone and are dropped.
+    thread_local bool t_metrics_destroyed = false;
+
+    struct ThreadHistogram {
+        std::array<std::atomic<uint64_t>, ServerMetrics::kBucketCount> buckets{};
+        std::atomic<int64_t> sum_nanos{0};
+    };
+
+    template <typename T>
+    void Bump(std::atomic<T>& slot, const T delta) {
+        // Only the owning thread writes, so load+store cannot lose updates and
+        // avoids a locked instruction on the hot path.
+        slot.store(slot.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    struct ThreadMetrics {
+        std::array<std::atomic<int64_t>, ServerMetrics::kMetricCount> values{};
+        std::array<ThreadHistogram, ServerMetrics::kLatencyMetricCount> latencies{};
+
+        ThreadMetrics() {
+            auto& registry = GetRegistry();
+            boost::lock_guard guard(registry.mutex);
+            registry.live.push_back(this);
+        }
+
+        ~ThreadMetrics() {
+            t_metrics_destroyed = true;
+            auto& registry = GetRegistry();
+            boost::lock_guard guard(registry.mutex);
+            AddTo(registry.retired);
+            std::erase(registry.live, this);
+        }
+
+        void AddTo(ServerMetrics::Snapshot& snapshot) const {
+            for (size_t i = 0; i < values.size(); ++i) {
+                snapshot.values[i] += values[i].load(std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < latencies.size(); ++i) {
+                const auto& source = latencies[i];
+                auto& target = snapshot.latencies[i];
+                for (size_t b = 0; b < source.buckets.size(); ++b) {
+                    target.buckets[b] += source.buckets[b].load(std::memory_order_relaxed);
+                }
+                target.sum += std::chrono::nanoseconds(source.sum_nanos.load(std::memory_order_relaxed));
+            }
+        }
+    };
+
+    thread_local ThreadMetrics t_metrics;
+
+    size_t BucketFor(const std::chrono::steady_clock::duration latency) {
+        const auto& bounds = ServerMetrics::kBucketBounds;
+        const auto it = std::lower_bound(bounds.begin(), bounds.end(), latency);
+        return static_cast<size_t>(it - bounds.begin());
+    }
+}
+
+uint64_t ServerMetrics::Histogram::Count() const {
+    uint64_t count = 0;
+    for (const uint64_t bucket : buckets) {
+        count += bucket;
+    }
+    return count;
+}
+
+int64_t ServerMetrics::Snapshot::Get(const Metric metric) const {
+    return values[static_cast<size_t>(metric)];
+}
+
+const ServerMetrics::Histogram& ServerMetrics::Snapshot::Get(const LatencyMetric metric) const {
+    return latencies[static_cast<size_t>(metric)];
+}
+
+void ServerMetrics::Add(const Metric metric, const int64_t delta) {
+    if (t_metrics_destroyed) return;
+    Bump(t_metrics.values[static_cast<size_t>(metric)], delta);
+}
+
+void ServerMetrics::Observe(const LatencyMetric metric, const std::chrono::steady_clock::duration latency) {
+    if (t_metrics_destroyed) return;
+    auto& histogram = t_metrics.latencies[static_cast<size_t>(metric)];
+    Bump(histogram.buckets[BucketFor(latency)], uint64_t{1});
+    Bump(histogram.sum_nanos, static_cast<int64_t>(std::chrono::nanoseconds(latency).count()));
+}
+
+ServerMetrics::Snapshot ServerMetrics::Collect() {
+    auto& registry = GetRegistry();
+    boost::lock_guard guard(registry.mutex);
+
+    Snapshot snapshot = registry.retired;
+    for (const auto* metrics : registry.live) {
+        metrics->AddTo(snapshot);
+    }
+    return snapshot;
+}
@@ -0,0 +1,283 @@
+#include "../include/slab_allocator.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <utility>
+#include <vector>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+#ifdef SERVER_POOLED_ALLOCATOR
+namespace {
+    struct ThreadSlab;
+
+    // Precedes every block handed out for a size class, so a block can find
+    // its way back to the slab that allocated it.
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) BlockHeader {
+        ThreadSlab* owner;
+        size_t size_class;
+    };
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct FreeList {
+        FreeBlock* head = nullptr;
+        size_t size = 0;
+    };
+
+    // Marks the return stack of a slab whose thread has exited.
+    FreeBlock* const kClosed = reinterpret_cast<FreeBlock*>(alignof(FreeBlock));
+
+    // Counters are written only by their owning thread; the registry lets
+    // GetStats sum live threads and keeps the totals of threads that exited.
+    struct Registry {
+        boost::mutex mutex;
+        std::vector<const ThreadSlab*> live;
+        SlabAllocator::Stats retired;
+        std::atomic<uint64_t> after_teardown{0};
+    };
+
+    Registry& GetRegistry() {
+        // Leaked. A slab is closed with its thread's other thread_locals,
+        // which for the delivery shard threads happens while static
+        // destructors run; the registry must still take its final counts.
+        static auto* registry = new Registry();
+        return *registry;
+    }
+
+    BlockHeader* HeaderOf(void* block) {
+        return static_cast<BlockHeader*>(block) - 1;
+    }
+
+    size_t SizeClassOf(const size_t bytes) {
+        const size_t block = std::bit_ceil(std::max(bytes, SlabAllocator::kMinBlock));
+        return std::countr_zero(block) - std::countr_zero(SlabAllocator::kMinBlock);
+    }
+
+    size_t BlockSizeOf(const size_t size_class) {
+        return SlabAllocator::kMinBlock << size_class;
+    }
+
+    void* NewBlock(ThreadSlab* owner, const size_t size_class) {
+        auto* header = static_cast<BlockHeader*>(::operator new(sizeof(BlockHeader) + BlockSizeOf(size_class)));
+        *header = {owner, size_class};
+        return header + 1;
+    }
+
+    // The blocks one thread allocated. Threads that free one of them hand it
+    // back through a lock-free stack, so the slab is reference counted: the
+    // owning thread holds one reference and every block it created another.
+    struct ThreadSlab {
+        // Touched by the owning thread only.
+        std::array<FreeList, SlabAllocator::kSizeClasses> lists;
+        // The owner always takes the whole stack, so a push never races with
+        // the pop of a single node.
+        std::atomic<FreeBlock*> returned{nullptr};
+        std::atomic<size_t> references{1};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> oversized{0};
+
+        ThreadSlab() {
+            auto& registry = GetRegistry();
+            boost::lock_guard guard(registry.mutex);
+            registry.live.push_back(this);
+        }
+
+        void Unref() {
+            if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+
+        void Destroy(void* block) {
+            ::operator delete(HeaderOf(block));
+            Unref();
+        }
+
+        void Keep(void* block) {
+            auto& list = lists[HeaderOf(block)->size_class];
+            if (list.size >= SlabAllocator::kMaxCachedPerClass) {
+                Destroy(block);
+                return;
+            }
+            list.head = ::new (block) FreeBlock{list.head};
+            ++list.size;
+        }
+
+        void CollectReturned() {
+            FreeBlock* block = returned.exchange(nullptr, std::memory_order_acquire);
+            while (block) {
+                Keep(std::exchange(block, block->next));
+            }
+        }
+
+        // Called from any thread. Once the owner has exited the block is freed.
+        void Return(void* block) {
+            FreeBlock* head = returned.load(std::memory_order_relaxed);
+            auto* node = ::new (block) FreeBlock{};
+            do {
+                if (head == kClosed) {
+                    Destroy(block);
+                    return;
+                }
+                node->next = head;
+            } while (!returned.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // Called by the owner as its thread exits. Blocks still in use
+        // elsewhere keep the slab alive until they are freed.
+        void Close() {
+            {
+                auto& registry = GetRegistry();
+                boost::lock_guard guard(registry.mutex);
+                registry.retired.hits += hits.load(std::memory_order_relaxed);
+                registry.retired.misses += misses.load(std::memory_order_relaxed);
+                registry.retired.oversized += oversized.load(std::memory_order_relaxed);
+                std::erase(registry.live, this);
+            }
+
+            for (auto& list : lists) {
+                while (list.head) {
+                    Destroy(std::exchange(list.head, list.head->next));
+                }
+                list.size = 0;
+            }
+
+            FreeBlock* block = returned.exchange(kClosed, std::memory_order_acquire);
+            while (block) {
+                Destroy(std::exchange(block, block->next));
+            }
+            Unref();
+        }
+
+        static void Bump(std::atomic<uint64_t>& counter) {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    };
+
+    enum class SlabState : uint8_t {
+        Unborn,
+        Alive,
+        Dead
+    };
+
+    // Trivially destructible, so allocations made while this thread's
+    // thread_locals are being destroyed can still tell the slab is gone.
+    thread_local SlabState t_slab_state = SlabState::Unborn;
+    thread_local ThreadSlab* t_slab = nullptr;
+
+    struct SlabCloser {
+        ~SlabCloser() {
+            t_slab_state = SlabState::Dead;
+            if (auto* slab = std::exchange(t_slab, nullptr)) {
+                slab->Close();
+            }
+        }
+    };
+
+    thread_local SlabCloser t_slab_closer;
+
+    ThreadSlab* LocalSlab() {
+        if (t_slab_state == SlabState::Unborn) {
+            // The first use registers the closer's destructor for this thread.
+            (void)&t_slab_closer;
+            t_slab = new ThreadSlab();
+            t_slab_state = SlabState::Alive;
+        }
+        return t_slab;
+    }
+}
+
+void* SlabAllocator::Allocate(const size_t bytes) {
+    ThreadSlab* slab = LocalSlab();
+    if (bytes > kMaxBlock) {
+        if (slab) ThreadSlab::Bump(slab->oversized);
+        return ::operator new(bytes);
+    }
+
+    const size_t size_class = SizeClassOf(bytes);
+    if (!slab) {
+        // The thread is exiting; an ownerless block is simply deleted.
+        GetRegistry().after_teardown.fetch_add(1, std::memory_order_relaxed);
+        return NewBlock(nullptr, size_class);
+    }
+
+    auto& list = slab->lists[size_class];
+    if (!list.head && slab->returned.load(std::memory_order_relaxed)) {
+        slab->CollectReturned();
+    }
+
+    if (list.head) {
+        FreeBlock* block = list.head;
+        list.head = block->next;
+        --list.size;
+        ThreadSlab::Bump(slab->hits);
+        return block;
+    }
+
+    ThreadSlab::Bump(slab->misses);
+    slab->references.fetch_add(1, std::memory_order_relaxed);
+    return NewBlock(slab, size_class);
+}
+
+void SlabAllocator::Deallocate(void* block, const size_t bytes) noexcept {
+    if (!block) return;
+
+    if (bytes > kMaxBlock) {
+        ::operator delete(block);
+        return;
+    }
+
+    ThreadSlab* owner = HeaderOf(block)->owner;
+    if (!owner) {
+        ::operator delete(HeaderOf(block));
+    } else if (t_slab_state == SlabState::Alive && owner == t_slab) {
+        owner->Keep(block);
+    } else {
+        owner->Return(block);
+    }
+}
+
+bool SlabAllocator::Enabled() {
+    return true;
+}
+
+SlabAllocator::Stats SlabAllocator::GetStats() {
+    auto& registry = GetRegistry();
+    boost::lock_guard guard(registry.mutex);
+
+    Stats stats = registry.retired;
+    stats.after_teardown = registry.after_teardown.load(std::memory_order_relaxed);
+    for (const auto* slab : registry.live) {
+        stats.hits += slab->hits.load(std::memory_order_relaxed);
+        stats.misses += slab->misses.load(std::memory_order_relaxed);
+        stats.oversized += slab->oversized.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+#else
+void* SlabAllocator::Allocate(const size_t bytes) {
+    return ::operator new(bytes);
+}
+
+void SlabAllocator::Deallocate(void* block, size_t) noexcept {
+    ::operator delete(block);
+}
+
+bool SlabAllocator::Enabled() {
+    return false;
+}
+
+SlabAllocator::Stats SlabAllocator::GetStats() {
+    return {};
+}
+#endif
+
+double SlabAllocator::Stats::HitRate() const {
+    const uint64_t requests = hits + misses + oversized + after_teardown;
+    return requests > 0 ? static_cast<double>(hits) / static_cast<double>(requests) : 0.0;
+}
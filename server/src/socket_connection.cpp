@@ -1,69 +1,306 @@
 #include "../include/socket_connection.h"
 #include "../include/rooms_singleton.h"
+#include "../include/message_pool.h"
+#include "../include/server_metrics.h"
+#include "../include/connection_registry.h"
+#include "../include/history_log.h"
+#include <algorithm>
 
-SocketConnection::SocketConnection(ip::tcp::socket&& socket)
+namespace {
+    // Handler state for composed operations is taken from the per-thread slab
+    // through asio's associated allocator.
+    template <typename Handler>
+    auto Pooled(Handler&& handler) {
+        return bind_allocator(PooledAllocator<void>(), std::forward<Handler>(handler));
+    }
+
+    std::atomic<uint64_t> g_next_connection_id{1};
+}
+
+SocketConnection::SocketConnection(ip::tcp::socket&& socket, ConnectionOptions options)
     : websocket_stream_(std::move(socket)),
-      heartbeat_timer_(websocket_stream_.get_executor()) {}
+      data_buffer_(options.max_frame_bytes),
+      options_(options),
+      connection_id_(g_next_connection_id.fetch_add(1, std::memory_order_relaxed)),
+      send_queue_(options_.max_queued_bytes, options_.overflow_policy),
+      inbound_messages_(options_.inbound.messages),
+      inbound_bytes_(options_.inbound.bytes),
+      read_resume_timer_(websocket_stream_.get_executor()) {
+    websocket_stream_.read_message_max(options_.max_frame_bytes);
+
+    if (options_.deflate.enabled) {
+        websocket::permessage_deflate deflate;
+        deflate.server_enable = true;
+        deflate.server_max_window_bits = options_.deflate.window_bits;
+        deflate.client_max_window_bits = options_.deflate.window_bits;
+        deflate.server_no_context_takeover = true;
+        deflate.memLevel = options_.deflate.mem_level;
+        websocket_stream_.set_option(deflate);
+    }
+
+    accepted_at_ = std::chrono::steady_clock::now();
+    ServerMetrics::Add(Metric::OpenConnections);
+}
 
 SocketConnection::~SocketConnection() {
+    ConnectionRegistry::GetInstance().Unregister(this);
+    RoomsSingleton::GetInstance()->UnsubscribeLobby(this);
+    HeartbeatManager::GetInstance().Cancel(heartbeat_handle_);
+
+    ServerMetrics::Add(Metric::OpenConnections, -1);
+    ServerMetrics::Add(Metric::QueuedMessages, -static_cast<int64_t>(reported_queued_messages_));
+    ServerMetrics::Add(Metric::QueuedBytes, -static_cast<int64_t>(reported_queued_bytes_));
+
     if (const auto room = associated_room_) {
-        room->RemoveConnection(boost::weak_ptr(shared_from_this()));
+        room->RemoveConnection(room_member_);
     }
 }
 
 void SocketConnection::InitializeWebsocket() {
+    dispatch(
+        GetExecutor(),
+        [self = shared_from_this()] {
+            // Read the upgrade request ourselves so the subprotocol can be
+            // chosen before the handshake is answered.
+            http::async_read(
+                self->websocket_stream_.next_layer(),
+                self->data_buffer_,
+                self->handshake_request_,
+                [self](const error_code& ec, std::size_t) {
+                    if (!ec) self->AcceptWebsocket();
+                });
+        });
+}
+
+void SocketConnection::AcceptWebsocket() {
+    if (!websocket::is_upgrade(handshake_request_)) {
+        return;
+    }
+
+    const auto header = handshake_request_[http::field::sec_websocket_protocol];
+    const std::string_view offered(header.data(), header.size());
+    wire_protocol_ = WireCodec::SelectProtocol(offered);
+
+    std::string selected;
+    if (wire_protocol_ == WireProtocol::Binary) {
+        selected = WireCodec::kBinarySubprotocol;
+    } else if (WireCodec::Offers(offered, WireCodec::kJsonSubprotocol)) {
+        selected = WireCodec::kJsonSubprotocol;
+    }
+
+    if (!selected.empty()) {
+        websocket_stream_.set_option(websocket::stream_base::decorator(
+            [selected](websocket::response_type& response) {
+                response.set(http::field::sec_websocket_protocol, selected);
+            }));
+    }
+    websocket_stream_.binary(wire_protocol_ == WireProtocol::Binary);
+
     websocket_stream_.async_accept(
+        handshake_request_,
         [self = shared_from_this()](const error_code& ec) {
+            self->handshake_request_ = {};
+            self->data_buffer_.consume(self->data_buffer_.size());
             if (!ec) self->ProcessInitialHandshake();
         });
 }
 
 void SocketConnection::TransmitData(const std::string& payload) {
+    TransmitData(MakeBroadcastMessage(payload));
+}
+
+void SocketConnection::TransmitData(const BroadcastMessagePtr& message) {
+    dispatch(
+        GetExecutor(),
+        Pooled([self = shared_from_this(), message] {
+            self->EnqueueMessage(message);
+        }));
+}
+
+void SocketConnection::EnqueueMessage(const BroadcastMessagePtr& message) {
+    switch (send_queue_.Push(message)) {
+        case OutboundQueue::PushResult::StartWrite:
+            WriteNextMessage();
+            break;
+        case OutboundQueue::PushResult::Overflow:
+            ServerMetrics::Add(Metric::DroppedSends);
+            send_queue_.Close();
+            TerminateConnection("Send queue overflow", websocket::close_code::policy_error);
+            break;
+        case OutboundQueue::PushResult::Dropped:
+            ServerMetrics::Add(Metric::DroppedSends);
+            break;
+        case OutboundQueue::PushResult::Queued:
+            break;
+    }
+    ReportQueueDepth();
+}
+
+void SocketConnection::ReportQueueDepth() {
+    // Publish only the change since the last report; the exported gauge is the
+    // sum over all connections.
+    const size_t messages = send_queue_.QueuedMessages();
+    const size_t bytes = send_queue_.QueuedBytes();
+    ServerMetrics::Add(Metric::QueuedMessages, static_cast<int64_t>(messages) - static_cast<int64_t>(reported_queued_messages_));
+    ServerMetrics::Add(Metric::QueuedBytes, static_cast<int64_t>(bytes) - static_cast<int64_t>(reported_queued_bytes_));
+    reported_queued_messages_ = messages;
+    reported_queued_bytes_ = bytes;
+}
+
+void SocketConnection::WriteNextMessage() {
+    const BroadcastMessage* message = send_queue_.Front();
+
+    // The queue keeps the front element alive and in place until PopFront,
+    // so the buffer stays valid for the whole write.
     websocket_stream_.async_write(
-        buffer(payload),
-        [self = shared_from_this()](error_code, auto) {}
-        );
+        message->BufferFor(wire_protocol_),
+        Pooled([self = shared_from_this()](const error_code& ec, const std::size_t bytes_transferred) {
+            self->HandleWriteCompletion(ec, bytes_transferred);
+        })
+    );
+}
+
+void SocketConnection::HandleWriteCompletion(const error_code& ec, const std::size_t bytes_transferred) {
+    if (ec) {
+        send_queue_.Close();
+    } else {
+        ServerMetrics::Add(Metric::MessagesOut);
+        ServerMetrics::Add(Metric::BytesOut, static_cast<int64_t>(bytes_transferred));
+    }
+    const bool has_more = send_queue_.PopFront();
+    ReportQueueDepth();
+
+    if (ec) {
+        LogEvent(LogLevel::Warn, "WebSocket write error", ec.message());
+        return;
+    }
+
+    if (has_more) {
+        WriteNextMessage();
+    } else if (draining_) {
+        CloseAfterDrain();
+    }
+}
+
+void SocketConnection::BeginShutdown() {
+    dispatch(
+        GetExecutor(),
+        [self = shared_from_this()] {
+            if (self->draining_) return;
+            self->draining_ = true;
+            self->StopHeartbeat();
+            RoomsSingleton::GetInstance()->UnsubscribeLobby(self.get());
+
+            if (!self->handshake_complete_) {
+                // Nothing to flush and no WebSocket to close politely.
+                get_lowest_layer(self->websocket_stream_).close();
+                return;
+            }
+
+            // Whatever is queued still goes out; the close frame follows it.
+            self->send_queue_.Seal();
+            if (!self->send_queue_.IsWriting()) {
+                self->CloseAfterDrain();
+            }
+        });
+}
+
+void SocketConnection::CloseAfterDrain() {
+    // The stream asserts on a second close; the peer may have started one.
+    if (close_sent_ || !websocket_stream_.is_open()) return;
+    close_sent_ = true;
+
+    websocket_stream_.async_close(
+        websocket::close_reason(websocket::close_code::going_away, "Server shutting down"),
+        [self = shared_from_this()](const error_code& ec) {
+            if (ec) self->LogEvent(LogLevel::Debug, "Close during shutdown failed", ec.message());
+        });
 }
 
 void SocketConnection::ProcessInitialHandshake() {
+    // The stream owns the callback, so it must not own the connection; it only
+    // runs inside reads that already hold a reference.
     websocket_stream_.control_callback(
-        [self = shared_from_this()](const websocket::frame_type ft, auto&&) {
-            if (ft == websocket::frame_type::pong) self->pong_received_ = true;
+        [this](const websocket::frame_type ft, auto&&) {
+            if (ft != websocket::frame_type::close) MarkActivity();
         });
 
+    handshake_complete_ = true;
+    ServerMetrics::Add(Metric::Handshakes);
+    ServerMetrics::Observe(LatencyMetric::AcceptToHandshake, std::chrono::steady_clock::now() - accepted_at_);
+
     UpdateRoomListing();
 }
 
 void SocketConnection::UpdateRoomListing() {
     const auto rooms = RoomsSingleton::GetInstance();
-    const json response{{"rooms", rooms->GetAllRoomNames()}};
 
-    TransmitData(response.dump());
+    // Subscribe before taking the snapshot so no change falls between the two.
+    rooms->SubscribeLobby(shared_from_this());
+    TransmitData(rooms->GetRoomListSnapshot().payload);
     PrepareSessionData();
 }
 
 void SocketConnection::PrepareSessionData() {
     websocket_stream_.async_read(data_buffer_,
         [self = shared_from_this()](error_code ec, auto) {
-            if (!ec) self->ProcessClientCommand(
-                json::parse(buffers_to_string(self->data_buffer_.data()))
-            );
+            if (ec) return;
+
+            RoomCommand cmd;
+            if (!self->DecodeClientCommand(cmd)) {
+                self->TerminateConnection("Malformed command", websocket::close_code::protocol_error);
+                return;
+            }
+
+            try {
+                self->ProcessClientCommand(cmd);
+            }
+            catch (const std::exception& e) {
+                self->LogEvent(LogLevel::Error, "Error processing command", e.what());
+                self->TerminateConnection(e.what(), websocket::close_code::policy_error);
+            }
         });
 }
 
+bool SocketConnection::DecodeClientCommand(RoomCommand& cmd) const {
+    const auto data = data_buffer_.data();
+    const std::string_view frame(static_cast<const char*>(data.data()), data.size());
+
+    if (wire_protocol_ == WireProtocol::Binary) {
+        WireCodec::RoomCommandView view;
+        if (!WireCodec::DecodeRoomCommand(frame, view)) return false;
+        cmd = view.ToCommand();
+        return true;
+    }
+
+    try {
+        cmd = json::parse(frame).get<RoomCommand>();
+        return true;
+    }
+    catch (const json::exception&) {
+        return false;
+    }
+}
+
 void SocketConnection::ProcessClientCommand(const RoomCommand& cmd) {
     user_identity_ = cmd.userName;
     const auto rooms = RoomsSingleton::GetInstance();
 
+    // Leave the lobby feed first so a creator is not told about its own room.
+    rooms->UnsubscribeLobby(this);
+
     if (cmd.operation == "create") {
-        associated_room_ = boost::make_shared<Room>(cmd.roomName);
+        associated_room_ = boost::make_shared<Room>(cmd.roomName, options_.room);
+        if (auto* log = HistoryLog::Active()) {
+            associated_room_->RestoreHistory(log->TakeRecovered(cmd.roomName));
+        }
         rooms->RegisterRoom(cmd.roomName, associated_room_);
     } else if (cmd.operation == "join") {
         associated_room_ = rooms->FetchRoom(cmd.roomName);
     }
 
     if (associated_room_) {
-        associated_room_->AddConnection(shared_from_this());
+        room_member_ = associated_room_->AddConnection(shared_from_this());
         MaintainConnection();
     }
 }
@@ -78,62 +315,171 @@ void SocketConnection::ReadNextMessage() {
 
     websocket_stream_.async_read(
         data_buffer_,
-        [self = shared_from_this()](const error_code &ec, std::size_t) {
+        Pooled([self = shared_from_this()](const error_code &ec, std::size_t) {
             if (ec) {
-                std::cerr << "WebSocket read error: " << ec.message() << std::endl;
+                self->LogEvent(LogLevel::Info, "WebSocket read error", ec.message());
+                self->StopHeartbeat();
                 return;
             }
 
+            self->MarkActivity();
+
             try {
-                self->associated_room_->DistributeMessage(buffers_to_string(self->data_buffer_.data()));
+                const auto data = self->data_buffer_.data();
+                const std::string_view payload(static_cast<const char*>(data.data()), data.size());
+                ServerMetrics::Add(Metric::MessagesIn);
+                ServerMetrics::Add(Metric::BytesIn, static_cast<int64_t>(payload.size()));
+
+                if (self->wire_protocol_ == WireProtocol::Binary) {
+                    WireCodec::RoomMessageView view;
+                    if (!WireCodec::DecodeRoomMessage(payload, view)) {
+                        self->TerminateConnection("Malformed message", websocket::close_code::protocol_error);
+                        return;
+                    }
+                    // The frame is relayed as sent, so its sender must be
+                    // the identity this connection joined with.
+                    if (view.username != self->user_identity_) {
+                        self->TerminateConnection("Sender does not match user", websocket::close_code::policy_error);
+                        return;
+                    }
+                }
 
-                self->ReadNextMessage();
+                const auto delay = self->ChargeInbound(payload.size());
+
+                // The frame is copied once, straight from the read buffer into
+                // a recycled message; no intermediate string is built.
+                self->associated_room_->DistributeMessage(
+                    MessagePool::Acquire(payload, self->wire_protocol_, self->user_identity_));
+
+                self->ResumeReading(delay);
             }
             catch (const std::exception& e) {
-                std::cerr << "Error processing message: " << e.what() << std::endl;
+                self->LogEvent(LogLevel::Error, "Error processing message", e.what());
             }
-        }
+        })
     );
 }
 
+std::chrono::steady_clock::duration SocketConnection::ChargeInbound(const size_t bytes) {
+    const auto now = std::chrono::steady_clock::now();
+    return std::max({
+        inbound_messages_.Charge(1, now),
+        inbound_bytes_.Charge(static_cast<double>(bytes), now),
+        associated_room_->ChargeInbound(bytes, now)
+    });
+}
+
+void SocketConnection::ResumeReading(const std::chrono::steady_clock::duration delay) {
+    if (delay <= std::chrono::steady_clock::duration::zero()) {
+        ReadNextMessage();
+        return;
+    }
+
+    // Over the limit: stop reading instead of buffering. Unread frames stay
+    // in the socket and TCP flow control slows the sender down.
+    ServerMetrics::Add(Metric::ReadPauses);
+    reads_paused_ = true;
+    read_resume_timer_.expires_after(delay);
+    read_resume_timer_.async_wait(
+        Pooled([self = shared_from_this()](const error_code& ec) {
+            self->reads_paused_ = false;
+            if (ec || self->close_sent_) return;
+            self->ReadNextMessage();
+        }));
+}
+
 void SocketConnection::ConfigureHeartbeat() {
-    heartbeat_timer_.cancel();
+    MarkActivity();
+    ScheduleHeartbeat(options_.ping_interval);
+}
 
-    heartbeat_timer_.expires_after(std::chrono::seconds(5));
-    heartbeat_timer_.async_wait(
-        [self = shared_from_this()](const error_code &ec) {
-            if (ec == boost::asio::error::operation_aborted) {
-                return;
-            }
+void SocketConnection::ScheduleHeartbeat(const std::chrono::steady_clock::duration delay) {
+    heartbeat_handle_ = HeartbeatManager::GetInstance().Schedule(
+        shared_from_this(),
+        std::chrono::ceil<std::chrono::milliseconds>(delay)
+    );
+}
 
-            if (!ec && !self->pong_received_) {
-                std::cout << "Heartbeat failure detected for user: " << self->user_identity_ << std::endl;
-                self->TerminateConnection("Heartbeat failure", websocket::close_code::internal_error);
-                return;
-            }
+void SocketConnection::StopHeartbeat() {
+    heartbeat_stopped_ = true;
+    HeartbeatManager::GetInstance().Cancel(heartbeat_handle_);
+    heartbeat_handle_ = {};
+}
 
-            self->pong_received_ = false;
+void SocketConnection::MarkActivity() {
+    last_activity_ = std::chrono::steady_clock::now();
+    ping_outstanding_ = false;
+}
 
-            try {
-                self->websocket_stream_.async_ping(
-                    "",
-                    [](auto){}
-                );
+void SocketConnection::HandleHeartbeatDue() {
+    heartbeat_handle_ = {};
+    if (heartbeat_stopped_) {
+        return;
+    }
 
-                self->ConfigureHeartbeat();
-            }
-            catch (const std::exception& e) {
-                std::cerr << "Error in heartbeat ping: " << e.what() << std::endl;
-            }
-        }
-    );
+    // A paused connection is quiet because we are not reading it.
+    if (reads_paused_) {
+        MarkActivity();
+        ScheduleHeartbeat(options_.ping_interval);
+        return;
+    }
+
+    // Any inbound frame counts as liveness, so busy connections are only
+    // rescheduled and never pinged.
+    const auto idle = std::chrono::steady_clock::now() - last_activity_;
+
+    if (idle >= options_.idle_timeout) {
+        LogEvent(LogLevel::Warn, "Heartbeat failure");
+        ServerMetrics::Add(Metric::HeartbeatFailures);
+        TerminateConnection("Heartbeat failure", websocket::close_code::internal_error);
+        return;
+    }
+
+    if (idle < options_.ping_interval) {
+        ScheduleHeartbeat(options_.ping_interval - idle);
+        return;
+    }
+
+    if (!ping_outstanding_) {
+        ping_outstanding_ = true;
+        websocket_stream_.async_ping("", [](auto) {});
+    }
+    ScheduleHeartbeat(options_.idle_timeout - idle);
 }
 
 std::string SocketConnection::GetUserIdentifier() const {
     return user_identity_;
 }
 
+any_io_executor SocketConnection::GetExecutor() {
+    return websocket_stream_.get_executor();
+}
+
+WireProtocol SocketConnection::GetWireProtocol() const {
+    return wire_protocol_;
+}
+
+void SocketConnection::LogEvent(const LogLevel level, const std::string_view message, const std::string_view detail) const {
+    auto& logger = Logger::GetInstance();
+    if (!logger.Enabled(level)) return;
+
+    const std::string_view room = associated_room_ ? std::string_view(associated_room_->GetName()) : std::string_view();
+    logger.Log(level, message, {
+        {"conn", connection_id_},
+        {"user", user_identity_},
+        {"room", room},
+        {"detail", detail}
+    });
+}
+
 void SocketConnection::TerminateConnection(const std::string &reason, const websocket::close_code close_code) {
+    StopHeartbeat();
+    read_resume_timer_.cancel();
+
+    // The stream asserts on a second close; the peer may have started one.
+    if (close_sent_ || !websocket_stream_.is_open()) return;
+    close_sent_ = true;
+
     const websocket::close_reason cr{
         close_code,
         reason
@@ -0,0 +1,100 @@
+#include "../include/timer_wheel.h"
+
+TimerWheel::TimerWheel(const size_t slot_count)
+    : slots_(slot_count > 0 ? slot_count : 1, kNil) {}
+
+TimerWheel::Handle TimerWheel::Schedule(const uint64_t ticks, const uint64_t payload) {
+    const uint64_t delay = ticks > 0 ? ticks : 1;
+
+    uint32_t index;
+    if (!free_nodes_.empty()) {
+        index = free_nodes_.back();
+        free_nodes_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    auto& node = nodes_[index];
+    node.payload = payload;
+    node.rounds = (delay - 1) / slots_.size();
+    node.slot = static_cast<uint32_t>((cursor_ + delay) % slots_.size());
+    node.prev = kNil;
+    node.next = slots_[node.slot];
+    node.active = true;
+
+    if (node.next != kNil) {
+        nodes_[node.next].prev = index;
+    }
+    slots_[node.slot] = index;
+    ++size_;
+
+    return {index, node.generation};
+}
+
+bool TimerWheel::Cancel(const Handle handle, uint64_t* payload) {
+    if (!handle.Valid() || handle.index >= nodes_.size()) {
+        return false;
+    }
+
+    const auto& node = nodes_[handle.index];
+    if (!node.active || node.generation != handle.generation) {
+        return false;
+    }
+
+    if (payload) {
+        *payload = node.payload;
+    }
+    Unlink(handle.index);
+    Release(handle.index);
+    return true;
+}
+
+void TimerWheel::Advance(std::vector<uint64_t>& expired) {
+    cursor_ = (cursor_ + 1) % slots_.size();
+
+    uint32_t index = slots_[cursor_];
+    while (index != kNil) {
+        auto& node = nodes_[index];
+        const uint32_t next = node.next;
+
+        if (node.rounds == 0) {
+            expired.push_back(node.payload);
+            Unlink(index);
+            Release(index);
+        } else {
+            --node.rounds;
+        }
+        index = next;
+    }
+}
+
+size_t TimerWheel::Size() const {
+    return size_;
+}
+
+size_t TimerWheel::SlotCount() const {
+    return slots_.size();
+}
+
+void TimerWheel::Unlink(const uint32_t index) {
+    const auto& node = nodes_[index];
+
+    if (node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        slots_[node.slot] = node.next;
+    }
+
+    if (node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    }
+}
+
+void TimerWheel::Release(const uint32_t index) {
+    auto& node = nodes_[index];
+    node.active = false;
+    ++node.generation;
+    free_nodes_.push_back(index);
+    --size_;
+}
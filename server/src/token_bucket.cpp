@@ -0,0 +1,29 @@
+#include "../include/token_bucket.h"
+#include <algorithm>
+
+TokenBucket::TokenBucket(const RateLimit limit)
+    : ns_per_token_(limit.per_second > 0.0 ? 1e9 / limit.per_second : 0.0),
+      burst_ns_(static_cast<int64_t>((limit.burst > 0.0 ? limit.burst : limit.per_second) * ns_per_token_)) {}
+
+bool TokenBucket::Limited() const {
+    return ns_per_token_ > 0.0;
+}
+
+TokenBucket::Clock::duration TokenBucket::Charge(const double cost, const Clock::time_point now) {
+    if (!Limited()) return Clock::duration::zero();
+
+    const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    const auto cost_ns = static_cast<int64_t>(cost * ns_per_token_);
+
+    // A bucket that has been full since before now starts filling from now.
+    int64_t full_at = full_at_.load(std::memory_order_relaxed);
+    int64_t next;
+    do {
+        next = std::max(full_at, now_ns) + cost_ns;
+    } while (!full_at_.compare_exchange_weak(full_at, next, std::memory_order_relaxed));
+
+    const int64_t wait_ns = next - now_ns - burst_ns_;
+    return wait_ns > 0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(wait_ns))
+        : Clock::duration::zero();
+}
@@ -0,0 +1,167 @@
+#include "../include/wire_codec.h"
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    template <typename T>
+    void AppendInt(std::string& out, T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    template <typename Length>
+    void AppendString(std::string& out, const std::string_view value) {
+        if (value.size() > std::numeric_limits<Length>::max()) {
+            throw std::length_error("Wire field too long");
+        }
+        AppendInt(out, static_cast<Length>(value.size()));
+        out.append(value);
+    }
+
+    class FrameReader {
+    public:
+        explicit FrameReader(const std::string_view frame) : frame_(frame) {}
+
+        template <typename T>
+        bool ReadInt(T& value) {
+            if (frame_.size() - offset_ < sizeof(T)) return false;
+            value = 0;
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                value |= static_cast<T>(static_cast<uint8_t>(frame_[offset_ + i])) << (8 * i);
+            }
+            offset_ += sizeof(T);
+            return true;
+        }
+
+        template <typename Length>
+        bool ReadString(std::string_view& value) {
+            Length length;
+            if (!ReadInt(length) || frame_.size() - offset_ < length) return false;
+            value = frame_.substr(offset_, length);
+            offset_ += length;
+            return true;
+        }
+
+        bool ReadType(const WireCodec::FrameType expected) {
+            uint8_t type;
+            return ReadInt(type) && type == static_cast<uint8_t>(expected);
+        }
+
+        bool AtEnd() const { return offset_ == frame_.size(); }
+
+    private:
+        std::string_view frame_;
+        size_t offset_ = 0;
+    };
+}
+
+RoomCommand WireCodec::RoomCommandView::ToCommand() const {
+    return RoomCommand{std::string(operation), std::string(roomName), std::string(userName)};
+}
+
+std::string WireCodec::EncodeRoomCommand(const RoomCommand& command) {
+    std::string frame;
+    frame.reserve(7 + command.operation.size() + command.roomName.size() + command.userName.size());
+    AppendInt(frame, static_cast<uint8_t>(FrameType::RoomCommand));
+    AppendString<uint16_t>(frame, command.operation);
+    AppendString<uint16_t>(frame, command.roomName);
+    AppendString<uint16_t>(frame, command.userName);
+    return frame;
+}
+
+bool WireCodec::DecodeRoomCommand(const std::string_view frame, RoomCommandView& command) {
+    FrameReader reader(frame);
+    return reader.ReadType(FrameType::RoomCommand)
+        && reader.ReadString<uint16_t>(command.operation)
+        && reader.ReadString<uint16_t>(command.roomName)
+        && reader.ReadString<uint16_t>(command.userName)
+        && reader.AtEnd();
+}
+
+std::string WireCodec::EncodeRoomMessage(const std::string_view username, const std::string_view message) {
+    std::string frame;
+    frame.reserve(7 + username.size() + message.size());
+    AppendInt(frame, static_cast<uint8_t>(FrameType::RoomMessage));
+    AppendString<uint16_t>(frame, username);
+    AppendString<uint32_t>(frame, message);
+    return frame;
+}
+
+bool WireCodec::DecodeRoomMessage(const std::string_view frame, RoomMessageView& message) {
+    FrameReader reader(frame);
+    return reader.ReadType(FrameType::RoomMessage)
+        && reader.ReadString<uint16_t>(message.username)
+        && reader.ReadString<uint32_t>(message.message)
+        && reader.AtEnd();
+}
+
+std::string WireCodec::EncodeRoomMessageBatch(const std::vector<std::string_view>& frames) {
+    size_t size = 5;
+    for (const auto frame : frames) {
+        size += 4 + frame.size();
+    }
+
+    std::string batch;
+    batch.reserve(size);
+    AppendInt(batch, static_cast<uint8_t>(FrameType::RoomMessageBatch));
+    AppendInt(batch, static_cast<uint32_t>(frames.size()));
+    for (const auto frame : frames) {
+        AppendString<uint32_t>(batch, frame);
+    }
+    return batch;
+}
+
+bool WireCodec::DecodeRoomMessageBatch(const std::string_view frame, std::vector<std::string_view>& frames) {
+    FrameReader reader(frame);
+    uint32_t count;
+    if (!reader.ReadType(FrameType::RoomMessageBatch) || !reader.ReadInt(count)) return false;
+
+    frames.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!reader.ReadString<uint32_t>(frames.emplace_back())) return false;
+    }
+    return reader.AtEnd();
+}
+
+std::string WireCodec::EncodeRoomList(const uint64_t version, const std::vector<std::string>& names) {
+    std::string frame;
+    AppendInt(frame, static_cast<uint8_t>(FrameType::RoomList));
+    AppendInt(frame, version);
+    AppendInt(frame, static_cast<uint32_t>(names.size()));
+    for (const auto& name : names) {
+        AppendString<uint16_t>(frame, name);
+    }
+    return frame;
+}
+
+std::string WireCodec::EncodeRoomListDelta(const bool added, const uint64_t version, const std::string_view name) {
+    std::string frame;
+    AppendInt(frame, static_cast<uint8_t>(FrameType::RoomListDelta));
+    AppendInt(frame, static_cast<uint8_t>(added ? 1 : 0));
+    AppendInt(frame, version);
+    AppendString<uint16_t>(frame, name);
+    return frame;
+}
+
+bool WireCodec::Offers(std::string_view offered_subprotocols, const std::string_view subprotocol) {
+    while (!offered_subprotocols.empty()) {
+        const size_t comma = offered_subprotocols.find(',');
+        auto token = offered_subprotocols.substr(0, comma);
+        offered_subprotocols = comma == std::string_view::npos
+            ? std::string_view{}
+            : offered_subprotocols.substr(comma + 1);
+
+        while (!token.empty() && (token.front() == ' ' || token.front() == '\t')) token.remove_prefix(1);
+        while (!token.empty() && (token.back() == ' ' || token.back() == '\t')) token.remove_suffix(1);
+
+        if (token == subprotocol) {
+            return true;
+        }
+    }
+    return false;
+}
+
+WireProtocol WireCodec::SelectProtocol(const std::string_view offered_subprotocols) {
+    return Offers(offered_subprotocols, kBinarySubprotocol) ? WireProtocol::Binary : WireProtocol::Json;
+}
@@ -0,0 +1,60 @@
+#!/usr/bin/env bash
+# Runs the same server_bench workload against an epoll build and an io_uring
+# build of the server and prints one line per backend. Arguments are passed to
+# server_bench unchanged, e.g.
+#
+#   server_bench/compare_backends.sh --connections=2000 --rooms=20 --rate=50000
+#
+# Environment: BUILD_DIR (default: build-backends), PORT (default: 8080),
+# ADMIN_PORT (default: 9100), SERVER_THREADS (default: 4).
+set -euo pipefail
+
+SOURCE_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD_DIR="${BUILD_DIR:-build-backends}"
+PORT="${PORT:-8080}"
+ADMIN_PORT="${ADMIN_PORT:-9100}"
+SERVER_THREADS="${SERVER_THREADS:-4}"
+
+build() {
+    local name="$1" uring="$2"
+    cmake -S "$SOURCE_DIR" -B "$BUILD_DIR/$name" -DCMAKE_BUILD_TYPE=Release -DSERVER_IO_URING="$uring" > /dev/null
+    cmake --build "$BUILD_DIR/$name" --target server server_bench -j"$(nproc)" > /dev/null
+}
+
+# Sum of chat_io_thread_busy_seconds_total over all io threads.
+io_cpu_seconds() {
+    curl -sf "http://127.0.0.1:$ADMIN_PORT/metrics" \
+        | awk '/^chat_io_thread_busy_seconds_total/ { sum += $NF } END { printf "%.3f", sum }'
+}
+
+run() {
+    local name="$1"
+    "$BUILD_DIR/$name/server/server" "$PORT" "$SERVER_THREADS" --admin-port="$ADMIN_PORT" --log-level=warn &
+    local server=$!
+    sleep 1
+
+    local before after
+    before="$(io_cpu_seconds)"
+    # The client always comes from the epoll build so only the server changes.
+    "$BUILD_DIR/epoll/server_bench/server_bench" --port="$PORT" --label="$name" "$@" > "$BUILD_DIR/$name.json"
+    after="$(io_cpu_seconds)"
+
+    python3 - "$BUILD_DIR/$name.json" "$before" "$after" <<'EOF'
+import json, sys
+report = json.load(open(sys.argv[1]))
+cpu = float(sys.argv[3]) - float(sys.argv[2])
+print(f"{report['label']:>9}  deliveries/s {report['deliveries_per_sec']:>12.0f}"
+      f"  p50 {report['latency_us']['p50']:>8.0f}us  p99 {report['latency_us']['p99']:>8.0f}us"
+      f"  server io cpu {cpu:>7.2f}s")
+EOF
+
+    kill -INT "$server"
+    wait "$server" || true
+}
+
+trap 'kill $(jobs -p) 2> /dev/null || true' EXIT
+
+build epoll OFF
+build io_uring ON
+run epoll "$@"
+run io_uring "$@"
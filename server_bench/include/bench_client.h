@@ -0,0 +1,82 @@
+#ifndef BENCH_CLIENT_H
+#define BENCH_CLIENT_H
+
+#include "latency_recorder.h"
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/smart_ptr.hpp>
+
+struct MeasurementWindow {
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+};
+
+// One simulated user. Connects, creates or joins its room with a JSON
+// RoomCommand, then records the delivery latency of every chat frame it
+// receives. Publishers embed their send time at the front of each payload.
+//
+// Each client is bound to one single-threaded io_context, so its handlers
+// never run concurrently and its counters need no synchronization.
+class BenchClient : public boost::enable_shared_from_this<BenchClient> {
+public:
+    using JoinedCallback = std::function<void()>;
+
+    BenchClient(
+        boost::asio::io_context& context,
+        std::string user_name,
+        std::string room_name,
+        bool creates_room
+    );
+
+    void Start(const boost::asio::ip::tcp::resolver::results_type& endpoints, JoinedCallback on_joined);
+    void Begin(MeasurementWindow window, std::chrono::nanoseconds publish_interval, size_t payload_bytes);
+    void Stop();
+
+    uint64_t Published() const;
+    uint64_t Delivered() const;
+    uint64_t SkippedPublishes() const;
+    LatencyRecorder& Latencies();
+
+private:
+    void Connect();
+    void Handshake();
+    void ReadRoomList();
+    void SendCommand();
+    void ReadNext();
+    void RecordFrame(std::string_view frame);
+    void RecordMessage(std::string_view message);
+    void SchedulePublish();
+    void Publish();
+    void Retry();
+
+    boost::asio::io_context& context_;
+    std::optional<boost::beast::websocket::stream<boost::beast::tcp_stream>> stream_;
+    boost::beast::flat_buffer read_buffer_;
+    boost::asio::steady_timer timer_;
+    boost::asio::ip::tcp::resolver::results_type endpoints_;
+    JoinedCallback on_joined_;
+
+    std::string user_name_;
+    std::string room_name_;
+    bool creates_room_;
+    std::string outgoing_;
+    bool write_pending_ = false;
+    bool stopped_ = false;
+
+    MeasurementWindow window_{};
+    std::chrono::nanoseconds publish_interval_{0};
+    std::chrono::steady_clock::time_point next_publish_;
+    size_t payload_bytes_ = 0;
+
+    uint64_t published_ = 0;
+    uint64_t delivered_ = 0;
+    uint64_t skipped_ = 0;
+    LatencyRecorder latencies_;
+};
+
+#endif // BENCH_CLIENT_H
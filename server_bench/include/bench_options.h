@@ -0,0 +1,27 @@
+#ifndef BENCH_OPTIONS_H
+#define BENCH_OPTIONS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+struct BenchOptions {
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    size_t connections = 100;
+    size_t rooms = 10;
+    size_t publishers = 0;
+    double rate = 1000.0;
+    size_t payload_bytes = 64;
+    size_t threads = 4;
+    std::chrono::milliseconds warmup{1000};
+    std::chrono::milliseconds duration{10000};
+    std::chrono::milliseconds drain{1000};
+    // Copied into the report to tell runs apart, e.g. the server backend.
+    std::string label;
+
+    static bool Parse(int arg_count, char** arg_values, BenchOptions& options);
+    static void PrintUsage(const char* program);
+};
+
+#endif // BENCH_OPTIONS_H
@@ -0,0 +1,26 @@
+#ifndef LATENCY_RECORDER_H
+#define LATENCY_RECORDER_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Raw delivery latency samples. Each client owns one and records without
+// locking; the load generator merges them once the run is over.
+class LatencyRecorder {
+public:
+    void Record(std::chrono::nanoseconds latency);
+    void Merge(const LatencyRecorder& other);
+
+    size_t Count() const;
+    std::chrono::nanoseconds Percentile(double percentile);
+    std::chrono::nanoseconds Max();
+
+private:
+    void Sort();
+
+    std::vector<int64_t> samples_;
+    bool sorted_ = true;
+};
+
+#endif // LATENCY_RECORDER_H
@@ -0,0 +1,41 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include "bench_client.h"
+#include "bench_options.h"
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <nlohmann/json.hpp>
+
+// Drives a swarm of BenchClients against a running server: rooms are created
+// first, the remaining clients join them round-robin, and then the publishers
+// send at a fixed total rate. The result is a JSON report suitable for
+// comparing releases.
+class LoadGenerator {
+public:
+    explicit LoadGenerator(BenchOptions options);
+    ~LoadGenerator();
+
+    LoadGenerator(const LoadGenerator&) = delete;
+    LoadGenerator& operator=(const LoadGenerator&) = delete;
+
+    nlohmann::json Run();
+
+private:
+    void StartThreads();
+    void StopThreads();
+    void JoinThreads();
+    bool ConnectClients(size_t first, size_t last, const boost::asio::ip::tcp::resolver::results_type& endpoints);
+    nlohmann::json BuildReport(std::chrono::steady_clock::duration measured);
+
+    BenchOptions options_;
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;
+    std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work_guards_;
+    std::vector<std::thread> threads_;
+    std::vector<boost::shared_ptr<BenchClient>> clients_;
+    boost::atomic<size_t> joined_{0};
+};
+
+#endif // LOAD_GENERATOR_H
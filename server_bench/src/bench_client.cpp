@@ -0,0 +1,251 @@
+#include "../include/bench_client.h"
+#include "../../server/include/room_command.h"
+#include <charconv>
+#include <iostream>
+
+namespace {
+    constexpr auto kRetryDelay = std::chrono::milliseconds(50);
+
+    int64_t NowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+BenchClient::BenchClient(
+    boost::asio::io_context& context,
+    std::string user_name,
+    std::string room_name,
+    const bool creates_room
+) :
+    context_(context),
+    timer_(context),
+    user_name_(std::move(user_name)),
+    room_name_(std::move(room_name)),
+    creates_room_(creates_room) {}
+
+void BenchClient::Start(const boost::asio::ip::tcp::resolver::results_type& endpoints, JoinedCallback on_joined) {
+    endpoints_ = endpoints;
+    on_joined_ = std::move(on_joined);
+    boost::asio::post(context_, [self = shared_from_this()] { self->Connect(); });
+}
+
+void BenchClient::Connect() {
+    if (stopped_) return;
+
+    stream_.emplace(context_);
+    boost::beast::get_lowest_layer(*stream_).async_connect(
+        endpoints_,
+        [self = shared_from_this()](const boost::system::error_code& ec, const auto&) {
+            if (ec) {
+                self->Retry();
+                return;
+            }
+            self->Handshake();
+        });
+}
+
+void BenchClient::Handshake() {
+    boost::beast::get_lowest_layer(*stream_).socket().set_option(boost::asio::ip::tcp::no_delay(true));
+
+    stream_->async_handshake(
+        endpoints_.begin()->host_name(),
+        "/",
+        [self = shared_from_this()](const boost::system::error_code& ec) {
+            if (ec) {
+                self->Retry();
+                return;
+            }
+            self->ReadRoomList();
+        });
+}
+
+void BenchClient::ReadRoomList() {
+    stream_->async_read(
+        read_buffer_,
+        [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+            if (ec) {
+                self->Retry();
+                return;
+            }
+
+            const auto data = self->read_buffer_.data();
+            const std::string_view frame(static_cast<const char*>(data.data()), data.size());
+
+            // A join for a room that is not registered yet is silently
+            // ignored by the server, so wait until the listing shows it.
+            bool room_listed = self->creates_room_;
+            if (!room_listed) {
+                try {
+                    const auto rooms = nlohmann::json::parse(frame).at("rooms");
+                    room_listed = std::find(rooms.begin(), rooms.end(), self->room_name_) != rooms.end();
+                } catch (const nlohmann::json::exception&) {
+                    room_listed = false;
+                }
+            }
+            self->read_buffer_.consume(self->read_buffer_.size());
+
+            if (!room_listed) {
+                self->Retry();
+                return;
+            }
+            self->SendCommand();
+        });
+}
+
+void BenchClient::SendCommand() {
+    const RoomCommand command{creates_room_ ? "create" : "join", room_name_, user_name_};
+    outgoing_ = nlohmann::json(command).dump();
+
+    stream_->async_write(
+        boost::asio::buffer(outgoing_),
+        [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+            if (ec) {
+                self->Retry();
+                return;
+            }
+            self->on_joined_();
+            self->ReadNext();
+        });
+}
+
+void BenchClient::ReadNext() {
+    stream_->async_read(
+        read_buffer_,
+        [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+            if (ec) return;
+
+            const auto data = self->read_buffer_.data();
+            self->RecordFrame(std::string_view(static_cast<const char*>(data.data()), data.size()));
+            self->read_buffer_.consume(self->read_buffer_.size());
+            self->ReadNext();
+        });
+}
+
+void BenchClient::RecordFrame(const std::string_view frame) {
+    if (!frame.starts_with('[')) {
+        RecordMessage(frame);
+        return;
+    }
+
+    // A batch from a room with batching on: a JSON array whose elements are
+    // the published texts as strings.
+    const auto batch = nlohmann::json::parse(frame, nullptr, false);
+    if (!batch.is_array()) return;
+    for (const auto& message : batch) {
+        if (message.is_string()) RecordMessage(message.get_ref<const std::string&>());
+    }
+}
+
+void BenchClient::RecordMessage(const std::string_view message) {
+    int64_t sent_at = 0;
+    const auto [end, error] = std::from_chars(message.data(), message.data() + message.size(), sent_at);
+    if (error != std::errc() || end == message.data() + message.size() || *end != ' ') {
+        return;
+    }
+
+    const auto sent = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(sent_at));
+    if (sent < window_.start || sent >= window_.end) {
+        return;
+    }
+
+    ++delivered_;
+    latencies_.Record(std::chrono::nanoseconds(NowNanos() - sent_at));
+}
+
+void BenchClient::Begin(
+    const MeasurementWindow window,
+    const std::chrono::nanoseconds publish_interval,
+    const size_t payload_bytes
+) {
+    boost::asio::post(context_, [self = shared_from_this(), window, publish_interval, payload_bytes] {
+        self->window_ = window;
+        self->publish_interval_ = publish_interval;
+        self->payload_bytes_ = payload_bytes;
+
+        if (publish_interval.count() > 0) {
+            self->next_publish_ = std::chrono::steady_clock::now();
+            self->SchedulePublish();
+        }
+    });
+}
+
+void BenchClient::SchedulePublish() {
+    if (stopped_ || next_publish_ >= window_.end) return;
+
+    timer_.expires_at(next_publish_);
+    timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+        if (ec) return;
+        self->Publish();
+    });
+}
+
+void BenchClient::Publish() {
+    const auto now = std::chrono::steady_clock::now();
+    const bool measured = now >= window_.start && now < window_.end;
+
+    // Keep a fixed cadence: a tick that finds the previous write still in
+    // flight is counted as skipped rather than queued behind it.
+    if (write_pending_) {
+        if (measured) ++skipped_;
+    } else {
+        outgoing_ = std::to_string(NowNanos());
+        outgoing_.push_back(' ');
+        if (outgoing_.size() < payload_bytes_) {
+            outgoing_.append(payload_bytes_ - outgoing_.size(), 'x');
+        }
+
+        write_pending_ = true;
+        if (measured) ++published_;
+        stream_->async_write(
+            boost::asio::buffer(outgoing_),
+            [self = shared_from_this()](const boost::system::error_code&, std::size_t) {
+                self->write_pending_ = false;
+            });
+    }
+
+    next_publish_ += publish_interval_;
+    SchedulePublish();
+}
+
+void BenchClient::Retry() {
+    if (stopped_) return;
+
+    if (stream_) {
+        boost::system::error_code ignored;
+        boost::beast::get_lowest_layer(*stream_).socket().close(ignored);
+    }
+    read_buffer_.consume(read_buffer_.size());
+
+    timer_.expires_after(kRetryDelay);
+    timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+        if (!ec) self->Connect();
+    });
+}
+
+void BenchClient::Stop() {
+    boost::asio::post(context_, [self = shared_from_this()] {
+        self->stopped_ = true;
+        self->timer_.cancel();
+        if (self->stream_) {
+            boost::system::error_code ignored;
+            boost::beast::get_lowest_layer(*self->stream_).socket().close(ignored);
+        }
+    });
+}
+
+uint64_t BenchClient::Published() const {
+    return published_;
+}
+
+uint64_t BenchClient::Delivered() const {
+    return delivered_;
+}
+
+uint64_t BenchClient::SkippedPublishes() const {
+    return skipped_;
+}
+
+LatencyRecorder& BenchClient::Latencies() {
+    return latencies_;
+}
@@ -0,0 +1,104 @@
+#include "../include/bench_options.h"
+#include <iostream>
+#include <string_view>
+
+namespace {
+    bool ParseCount(const std::string& value, size_t& out) {
+        try {
+            const long long parsed = std::stoll(value);
+            if (parsed < 0) return false;
+            out = static_cast<size_t>(parsed);
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    bool ParseMillis(const std::string& value, std::chrono::milliseconds& out) {
+        size_t millis = 0;
+        if (!ParseCount(value, millis)) return false;
+        out = std::chrono::milliseconds(millis);
+        return true;
+    }
+}
+
+bool BenchOptions::Parse(const int arg_count, char** arg_values, BenchOptions& options) {
+    for (int i = 1; i < arg_count; ++i) {
+        const std::string arg = arg_values[i];
+        const size_t equals = arg.find('=');
+        if (!arg.starts_with("--") || equals == std::string::npos) {
+            std::cerr << "Unknown argument '" << arg << "'" << std::endl;
+            PrintUsage(arg_values[0]);
+            return false;
+        }
+
+        const std::string key = arg.substr(2, equals - 2);
+        const std::string value = arg.substr(equals + 1);
+        bool valid = true;
+
+        if (key == "host") {
+            options.host = value;
+        } else if (key == "port") {
+            options.port = value;
+        } else if (key == "connections") {
+            valid = ParseCount(value, options.connections) && options.connections > 0;
+        } else if (key == "rooms") {
+            valid = ParseCount(value, options.rooms) && options.rooms > 0;
+        } else if (key == "publishers") {
+            valid = ParseCount(value, options.publishers);
+        } else if (key == "rate") {
+            try {
+                options.rate = std::stod(value);
+                valid = options.rate > 0.0;
+            } catch (const std::exception&) {
+                valid = false;
+            }
+        } else if (key == "payload") {
+            valid = ParseCount(value, options.payload_bytes);
+        } else if (key == "threads") {
+            valid = ParseCount(value, options.threads) && options.threads > 0;
+        } else if (key == "warmup-ms") {
+            valid = ParseMillis(value, options.warmup);
+        } else if (key == "duration-ms") {
+            valid = ParseMillis(value, options.duration) && options.duration.count() > 0;
+        } else if (key == "drain-ms") {
+            valid = ParseMillis(value, options.drain);
+        } else if (key == "label") {
+            options.label = value;
+        } else {
+            std::cerr << "Unknown option '" << arg << "'" << std::endl;
+            PrintUsage(arg_values[0]);
+            return false;
+        }
+
+        if (!valid) {
+            std::cerr << "Invalid value for --" << key << ": '" << value << "'" << std::endl;
+            return false;
+        }
+    }
+
+    if (options.rooms > options.connections) {
+        std::cerr << "--rooms cannot exceed --connections" << std::endl;
+        return false;
+    }
+    if (options.publishers == 0 || options.publishers > options.connections) {
+        options.publishers = options.connections;
+    }
+    return true;
+}
+
+void BenchOptions::PrintUsage(const char* program) {
+    std::cerr << "Execution format: " << program << " [options]" << std::endl;
+    std::cerr << "  --host=ADDR        - Server address (default: 127.0.0.1)" << std::endl;
+    std::cerr << "  --port=PORT        - Server port (default: 8080)" << std::endl;
+    std::cerr << "  --connections=N    - WebSocket clients to open (default: 100)" << std::endl;
+    std::cerr << "  --rooms=M          - Rooms to create; clients join them round-robin (default: 10)" << std::endl;
+    std::cerr << "  --publishers=P     - Clients that publish; 0 means all (default: 0)" << std::endl;
+    std::cerr << "  --rate=R           - Total published messages per second (default: 1000)" << std::endl;
+    std::cerr << "  --payload=BYTES    - Published message size (default: 64)" << std::endl;
+    std::cerr << "  --threads=T        - Client io threads (default: 4)" << std::endl;
+    std::cerr << "  --warmup-ms=MS     - Publishing time excluded from results (default: 1000)" << std::endl;
+    std::cerr << "  --duration-ms=MS   - Measured publishing time (default: 10000)" << std::endl;
+    std::cerr << "  --drain-ms=MS      - Time allowed for in-flight deliveries (default: 1000)" << std::endl;
+    std::cerr << "  --label=NAME       - Name recorded in the report (default: none)" << std::endl;
+}
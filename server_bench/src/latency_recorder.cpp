@@ -0,0 +1,41 @@
+#include "../include/latency_recorder.h"
+#include <algorithm>
+#include <cmath>
+
+void LatencyRecorder::Record(const std::chrono::nanoseconds latency) {
+    samples_.push_back(latency.count());
+    sorted_ = false;
+}
+
+void LatencyRecorder::Merge(const LatencyRecorder& other) {
+    samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    sorted_ = false;
+}
+
+size_t LatencyRecorder::Count() const {
+    return samples_.size();
+}
+
+std::chrono::nanoseconds LatencyRecorder::Percentile(const double percentile) {
+    if (samples_.empty()) return std::chrono::nanoseconds::zero();
+    Sort();
+
+    // Nearest-rank: the smallest sample with at least `percentile` of the
+    // samples at or below it.
+    const auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(samples_.size())));
+    const size_t index = std::clamp<size_t>(rank, 1, samples_.size()) - 1;
+    return std::chrono::nanoseconds(samples_[index]);
+}
+
+std::chrono::nanoseconds LatencyRecorder::Max() {
+    if (samples_.empty()) return std::chrono::nanoseconds::zero();
+    Sort();
+    return std::chrono::nanoseconds(samples_.back());
+}
+
+void LatencyRecorder::Sort() {
+    if (!sorted_) {
+        std::sort(samples_.begin(), samples_.end());
+        sorted_ = true;
+    }
+}
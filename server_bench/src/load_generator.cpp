@@ -0,0 +1,164 @@
+#include "../include/load_generator.h"
+#include <iostream>
+
+namespace {
+    constexpr auto kJoinTimeout = std::chrono::seconds(30);
+    constexpr auto kPollInterval = std::chrono::milliseconds(10);
+
+    double ToMicros(const std::chrono::nanoseconds value) {
+        return static_cast<double>(value.count()) / 1000.0;
+    }
+
+    double ToSeconds(const std::chrono::steady_clock::duration value) {
+        return std::chrono::duration<double>(value).count();
+    }
+}
+
+LoadGenerator::LoadGenerator(BenchOptions options)
+    : options_(std::move(options)) {}
+
+LoadGenerator::~LoadGenerator() {
+    StopThreads();
+}
+
+nlohmann::json LoadGenerator::Run() {
+    StartThreads();
+
+    boost::asio::ip::tcp::resolver resolver(*contexts_.front());
+    const auto endpoints = resolver.resolve(options_.host, options_.port);
+
+    for (size_t i = 0; i < options_.connections; ++i) {
+        const size_t room = i % options_.rooms;
+        clients_.push_back(boost::make_shared<BenchClient>(
+            *contexts_[i % contexts_.size()],
+            "bench-" + std::to_string(i),
+            "bench-room-" + std::to_string(room),
+            i < options_.rooms
+        ));
+    }
+
+    // Creators first: joiners wait for their room to appear in the listing.
+    std::cerr << "Creating " << options_.rooms << " rooms" << std::endl;
+    if (!ConnectClients(0, options_.rooms, endpoints)) {
+        throw std::runtime_error("Timed out creating rooms");
+    }
+    std::cerr << "Joining " << options_.connections - options_.rooms << " clients" << std::endl;
+    if (!ConnectClients(options_.rooms, options_.connections, endpoints)) {
+        throw std::runtime_error("Timed out joining rooms");
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const MeasurementWindow window{now + options_.warmup, now + options_.warmup + options_.duration};
+    const auto publish_interval = std::chrono::nanoseconds(static_cast<int64_t>(
+        1e9 * static_cast<double>(options_.publishers) / options_.rate));
+
+    std::cerr << "Publishing at " << options_.rate << " msg/s from " << options_.publishers << " clients" << std::endl;
+    for (size_t i = 0; i < clients_.size(); ++i) {
+        // Rooms are dealt out round-robin, so the first clients publish into
+        // consecutive rooms; every room carries traffic once there are at
+        // least as many publishers as rooms.
+        const bool publishes = i < options_.publishers;
+        clients_[i]->Begin(window, publishes ? publish_interval : std::chrono::nanoseconds::zero(), options_.payload_bytes);
+    }
+
+    std::this_thread::sleep_until(window.end + options_.drain);
+
+    // Closing every socket completes the outstanding reads, so the threads
+    // run out of work on their own once the guards are released.
+    for (const auto& client : clients_) {
+        client->Stop();
+    }
+    work_guards_.clear();
+    JoinThreads();
+
+    return BuildReport(window.end - window.start);
+}
+
+void LoadGenerator::StartThreads() {
+    for (size_t i = 0; i < options_.threads; ++i) {
+        auto& context = *contexts_.emplace_back(std::make_unique<boost::asio::io_context>(1));
+        work_guards_.emplace_back(boost::asio::make_work_guard(context));
+    }
+
+    for (const auto& context : contexts_) {
+        threads_.emplace_back([&context = *context] {
+            try {
+                context.run();
+            } catch (const std::exception& e) {
+                std::cerr << "Client thread exception: " << e.what() << std::endl;
+            }
+        });
+    }
+}
+
+void LoadGenerator::StopThreads() {
+    work_guards_.clear();
+    for (const auto& context : contexts_) {
+        context->stop();
+    }
+    JoinThreads();
+}
+
+void LoadGenerator::JoinThreads() {
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+bool LoadGenerator::ConnectClients(
+    const size_t first,
+    const size_t last,
+    const boost::asio::ip::tcp::resolver::results_type& endpoints
+) {
+    for (size_t i = first; i < last; ++i) {
+        clients_[i]->Start(endpoints, [this] { ++joined_; });
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + kJoinTimeout;
+    while (joined_.load() < last) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(kPollInterval);
+    }
+    return true;
+}
+
+nlohmann::json LoadGenerator::BuildReport(const std::chrono::steady_clock::duration measured) {
+    uint64_t published = 0;
+    uint64_t delivered = 0;
+    uint64_t skipped = 0;
+    LatencyRecorder latencies;
+
+    for (const auto& client : clients_) {
+        published += client->Published();
+        delivered += client->Delivered();
+        skipped += client->SkippedPublishes();
+        latencies.Merge(client->Latencies());
+    }
+
+    const double seconds = ToSeconds(measured);
+    return {
+        {"label", options_.label},
+        {"connections", options_.connections},
+        {"rooms", options_.rooms},
+        {"publishers", options_.publishers},
+        {"target_rate", options_.rate},
+        {"payload_bytes", options_.payload_bytes},
+        {"duration_s", seconds},
+        {"published", published},
+        {"delivered", delivered},
+        {"skipped_publishes", skipped},
+        {"messages_per_sec", static_cast<double>(published) / seconds},
+        {"deliveries_per_sec", static_cast<double>(delivered) / seconds},
+        {"fanout", published > 0 ? static_cast<double>(delivered) / static_cast<double>(published) : 0.0},
+        {"latency_us", {
+            {"samples", latencies.Count()},
+            {"p50", ToMicros(latencies.Percentile(50.0))},
+            {"p99", ToMicros(latencies.Percentile(99.0))},
+            {"p999", ToMicros(latencies.Percentile(99.9))},
+            {"max", ToMicros(latencies.Max())}
+        }}
+    };
+}
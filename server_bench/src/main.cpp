@@ -0,0 +1,16 @@
+#include "../include/load_generator.h"
+#include <iostream>
+
+int main(const int argc, char* argv[]) {
+    BenchOptions options;
+    if (!BenchOptions::Parse(argc, argv, options)) return 1;
+
+    try {
+        LoadGenerator generator(options);
+        std::cout << generator.Run().dump(2) << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "benchmark/benchmark.h"
+#include "sink_connections.h"
+#include "../../server/include/room.h"
+#include "../../server/include/message_pool.h"
+
+namespace {
+    constexpr auto kRoomName = "microbench-room";
+    constexpr int64_t kDrainEvery = 64;
+
+    boost::shared_ptr<Room> g_room;
+    std::vector<boost::shared_ptr<SocketConnection>> g_members;
+    std::string g_payload;
+
+    void SetUpMembers(const benchmark::State& state, const RoomOptions& options = {}) {
+        g_room = boost::make_shared<Room>(kRoomName, options);
+        g_members = SinkConnections::GetInstance().Make(static_cast<size_t>(state.range(0)));
+        for (const auto& member : g_members) {
+            g_room->AddConnection(member);
+        }
+    }
+
+    void SetUpRoomWith(const benchmark::State& state, const RoomOptions& options) {
+        SetUpMembers(state, options);
+        g_payload.assign(state.range(1), 'x');
+    }
+
+    void SetUpRoom(const benchmark::State& state) {
+        SetUpRoomWith(state, {});
+    }
+
+    // The window never expires during a run; batches are cut by the message
+    // cap, which matches the drain cadence.
+    void SetUpBatchedRoom(const benchmark::State& state) {
+        RoomOptions options;
+        options.batch = {.window = std::chrono::seconds(1), .max_messages = static_cast<size_t>(kDrainEvery)};
+        SetUpRoomWith(state, options);
+    }
+
+    void TearDownRoom(const benchmark::State&) {
+        auto& sinks = SinkConnections::GetInstance();
+        sinks.Drain(kRoomName);
+        g_members.clear();
+        g_room.reset();
+        sinks.Release();
+    }
+
+    // Publishes into one shared room from every benchmark thread. Deliveries
+    // are drained inside the timed loop, so the rate is the sustained fan-out
+    // rate rather than the rate at which work can be queued.
+    void BM_RoomDistributeMessage(benchmark::State& state) {
+        auto& sinks = SinkConnections::GetInstance();
+        const auto room = g_room;
+
+        for (auto _ : state) {
+            room->DistributeMessage(MessagePool::Acquire(g_payload, WireProtocol::Json, "microbench"));
+            if (state.iterations() % kDrainEvery == 0) {
+                sinks.Drain(kRoomName);
+            }
+        }
+        sinks.Drain(kRoomName);
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetBytesProcessed(state.iterations() * state.range(1));
+    }
+
+    // Same load with deliveries packed kDrainEvery messages to a frame.
+    void BM_RoomDistributeBatched(benchmark::State& state) {
+        BM_RoomDistributeMessage(state);
+    }
+
+    // Joins and leaves a room that already holds range(0) members.
+    void BM_RoomAddRemoveConnection(benchmark::State& state) {
+        const auto room = g_room;
+        const auto connection = SinkConnections::GetInstance().Make();
+        const boost::weak_ptr<SocketConnection> member(connection);
+
+        for (auto _ : state) {
+            room->RemoveConnection(room->AddConnection(member));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_RoomDistributeMessage)
+    ->ArgNames({"members", "bytes"})
+    ->ArgsProduct({{1, 16, 256, 1024}, {64, 1024, 16384}})
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Setup(SetUpRoom)
+    ->Teardown(TearDownRoom);
+
+BENCHMARK(BM_RoomDistributeBatched)
+    ->ArgNames({"members", "bytes"})
+    ->ArgsProduct({{1, 16, 256, 1024}, {64, 1024, 16384}})
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Setup(SetUpBatchedRoom)
+    ->Teardown(TearDownRoom);
+
+BENCHMARK(BM_RoomAddRemoveConnection)
+    ->ArgName("members")
+    ->Arg(1)->Arg(16)->Arg(256)->Arg(4096)
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Setup([](const benchmark::State& state) { SetUpMembers(state); })
+    ->Teardown(TearDownRoom);
@@ -0,0 +1,73 @@
+#include "benchmark/benchmark.h"
+#include "../../server/include/rooms_singleton.h"
+
+namespace {
+    std::vector<std::string> g_room_names;
+
+    void RegisterBackgroundRooms(const benchmark::State& state) {
+        const auto rooms = RoomsSingleton::GetInstance();
+        const auto count = static_cast<size_t>(state.range(0));
+
+        g_room_names.clear();
+        g_room_names.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto& name = g_room_names.emplace_back("microbench-registry-" + std::to_string(i));
+            rooms->RegisterRoom(name, boost::make_shared<Room>(name));
+        }
+    }
+
+    void UnregisterBackgroundRooms(const benchmark::State&) {
+        const auto rooms = RoomsSingleton::GetInstance();
+        for (const auto& name : g_room_names) {
+            rooms->UnregisterRoom(name);
+        }
+        g_room_names.clear();
+    }
+
+    // Lock-free lookups spread over range(0) registered rooms.
+    void BM_RoomsSingletonFetchRoom(benchmark::State& state) {
+        const auto rooms = RoomsSingleton::GetInstance();
+        size_t next = static_cast<size_t>(state.thread_index());
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(rooms->FetchRoom(g_room_names[next++ % g_room_names.size()]));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Register/unregister pairs while range(0) other rooms are registered;
+    // each write copies its shard's map, so the cost grows with shard size.
+    void BM_RoomsSingletonRegisterRoom(benchmark::State& state) {
+        const auto rooms = RoomsSingleton::GetInstance();
+        const auto room = boost::make_shared<Room>("microbench-churn");
+
+        std::vector<std::string> names;
+        for (size_t i = 0; i < 64; ++i) {
+            names.push_back("microbench-churn-" + std::to_string(state.thread_index()) + "-" + std::to_string(i));
+        }
+
+        size_t next = 0;
+        for (auto _ : state) {
+            const auto& name = names[next++ % names.size()];
+            rooms->RegisterRoom(name, room);
+            rooms->UnregisterRoom(name);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_RoomsSingletonFetchRoom)
+    ->ArgName("rooms")
+    ->Arg(16)->Arg(1024)->Arg(16384)
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Setup(RegisterBackgroundRooms)
+    ->Teardown(UnregisterBackgroundRooms);
+
+BENCHMARK(BM_RoomsSingletonRegisterRoom)
+    ->ArgName("rooms")
+    ->Arg(0)->Arg(1024)->Arg(16384)
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Setup(RegisterBackgroundRooms)
+    ->Teardown(UnregisterBackgroundRooms);
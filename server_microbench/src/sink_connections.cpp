@@ -0,0 +1,111 @@
+#include "sink_connections.h"
+#include "../../server/include/delivery_executor.h"
+#include "../../server/include/server_metrics.h"
+#include <future>
+#include <utility>
+
+struct SinkConnections::Client {
+    websocket::stream<ip::tcp::socket> stream;
+    flat_buffer frame;
+
+    explicit Client(io_context& context)
+        : stream(context) {}
+
+    static void ReadNext(const std::shared_ptr<Client>& client) {
+        client->stream.async_read(client->frame, [client](const error_code& ec, std::size_t) {
+            if (ec) return;
+            client->frame.clear();
+            ReadNext(client);
+        });
+    }
+};
+
+namespace {
+    // Several benchmark threads publish into one room between drains, which
+    // can queue more per sink than the default limit allows.
+    ConnectionOptions SinkOptions() {
+        ConnectionOptions options;
+        options.max_queued_bytes = 256 * 1024 * 1024;
+        return options;
+    }
+
+    template <typename Executor>
+    void Fence(const Executor& executor) {
+        std::promise<void> reached;
+        post(executor, [&reached] { reached.set_value(); });
+        reached.get_future().wait();
+    }
+}
+
+SinkConnections::SinkConnections()
+    : work_guard_(make_work_guard(context_)),
+      acceptor_(context_, ip::tcp::endpoint(ip::address_v4::loopback(), 0)),
+      thread_([this] { context_.run(); }) {}
+
+SinkConnections::~SinkConnections() {
+    work_guard_.reset();
+    context_.stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+SinkConnections& SinkConnections::GetInstance() {
+    static SinkConnections instance;
+    return instance;
+}
+
+boost::shared_ptr<SocketConnection> SinkConnections::Make() {
+    // Connect and accept synchronously on the caller's thread; the server
+    // side answers the handshake on the sink thread.
+    std::lock_guard guard(clients_mutex_);
+    const auto client = std::make_shared<Client>(context_);
+    client->stream.next_layer().connect(acceptor_.local_endpoint());
+    const auto connection = boost::make_shared<SocketConnection>(acceptor_.accept(), SinkOptions());
+    connection->InitializeWebsocket();
+    client->stream.handshake("localhost", "/");
+
+    // The room listing follows the server's side of the handshake; a room
+    // must not write to the connection before that.
+    client->stream.read(client->frame);
+    client->frame.clear();
+
+    post(context_, [client] { Client::ReadNext(client); });
+    clients_.push_back(client);
+    return connection;
+}
+
+std::vector<boost::shared_ptr<SocketConnection>> SinkConnections::Make(const size_t count) {
+    std::vector<boost::shared_ptr<SocketConnection>> connections;
+    connections.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        connections.push_back(Make());
+    }
+    return connections;
+}
+
+void SinkConnections::Drain(const std::string_view room_name) {
+    // The shard runs a room's deliveries in order, and the single sink thread
+    // runs TransmitData hops in order, so one fence on each puts every
+    // delivery in its queue. The writes then finish on the sink thread.
+    Fence(DeliveryExecutor::GetInstance().ShardFor(room_name));
+    Fence(context_.get_executor());
+    while (ServerMetrics::Collect().Get(Metric::QueuedMessages) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void SinkConnections::Release() {
+    std::lock_guard guard(clients_mutex_);
+    post(context_, [clients = std::exchange(clients_, {})] {
+        for (const auto& client : clients) {
+            error_code ignored;
+            client->stream.next_layer().close(ignored);
+        }
+    });
+
+    // Sinks left behind would still be sent every lobby change.
+    while (ServerMetrics::Collect().Get(Metric::OpenConnections) > 0) {
+        std::this_thread::yield();
+    }
+}
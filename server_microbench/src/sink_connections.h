@@ -0,0 +1,49 @@
+#ifndef SINK_CONNECTIONS_H
+#define SINK_CONNECTIONS_H
+
+#include "../../server/include/socket_connection.h"
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// In-process stand-ins for clients. Each is a SocketConnection accepted over
+// loopback from a WebSocket client that reads and discards every frame, so a
+// delivery takes the full path through Room, the delivery shard, the queue
+// and the socket write. Both ends live on a private io_context run by one
+// background thread.
+class SinkConnections {
+public:
+    SinkConnections();
+    ~SinkConnections();
+
+    SinkConnections(const SinkConnections&) = delete;
+    SinkConnections& operator=(const SinkConnections&) = delete;
+
+    static SinkConnections& GetInstance();
+
+    boost::shared_ptr<SocketConnection> Make();
+    std::vector<boost::shared_ptr<SocketConnection>> Make(size_t count);
+
+    // Waits until every delivery already posted for the room has been
+    // written to its sink's socket.
+    void Drain(std::string_view room_name);
+
+    // Disconnects every client made so far and waits until their server
+    // connections are gone. The caller must have dropped its references.
+    void Release();
+
+private:
+    struct Client;
+
+    io_context context_;
+    executor_work_guard<io_context::executor_type> work_guard_;
+    ip::tcp::acceptor acceptor_;
+    // Benchmark threads make sinks concurrently.
+    std::mutex clients_mutex_;
+    std::vector<std::shared_ptr<Client>> clients_;
+    std::thread thread_;
+};
+
+#endif // SINK_CONNECTIONS_H
@@ -0,0 +1,41 @@
+#include "gtest/gtest.h"
+#include "../../server/include/delivery_executor.h"
+#include <boost/asio/post.hpp>
+#include <future>
+#include <vector>
+
+TEST(DeliveryExecutorTest, SameKeyMapsToSameShard) {
+    const DeliveryExecutor executor(2, 16);
+
+    EXPECT_EQ(executor.ShardCount(), 16);
+    EXPECT_TRUE(executor.ShardFor("lobby") == executor.ShardFor("lobby"));
+}
+
+TEST(DeliveryExecutorTest, ShardCountDefaultsToMultipleOfThreads) {
+    const DeliveryExecutor executor(3, 0);
+
+    EXPECT_EQ(executor.ThreadCount(), 3);
+    EXPECT_EQ(executor.ShardCount() % 3, 0);
+}
+
+TEST(DeliveryExecutorTest, PreservesOrderWithinShard) {
+    DeliveryExecutor executor(4, 0);
+    const auto shard = executor.ShardFor("ordered_room");
+
+    std::vector<int> delivered;
+    std::promise<void> done;
+    constexpr int kMessages = 1000;
+
+    for (int i = 0; i < kMessages; ++i) {
+        boost::asio::post(shard, [&delivered, &done, i] {
+            delivered.push_back(i);
+            if (i == kMessages - 1) done.set_value();
+        });
+    }
+
+    done.get_future().wait();
+    ASSERT_EQ(delivered.size(), kMessages);
+    for (int i = 0; i < kMessages; ++i) {
+        EXPECT_EQ(delivered[i], i);
+    }
+}
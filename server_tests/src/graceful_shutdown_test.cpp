@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "../../server/include/graceful_shutdown.h"
+#include "../../server/include/connection_registry.h"
+#include "../../server/include/socket_connection.h"
+#include <future>
+#include <optional>
+#include <thread>
+
+TEST(GracefulShutdownTest, SendsGoingAwayAndWaitsForConnectionsToClose) {
+    io_context server_ioc;
+    auto work = make_work_guard(server_ioc);
+    ip::tcp::acceptor acceptor(server_ioc, ip::tcp::endpoint(ip::address_v4::loopback(), 0));
+    acceptor.async_accept([](const error_code& ec, ip::tcp::socket socket) {
+        if (ec) return;
+        const auto connection = boost::make_shared<SocketConnection>(std::move(socket));
+        ConnectionRegistry::GetInstance().Register(connection);
+        connection->InitializeWebsocket();
+    });
+    std::thread server([&server_ioc] { server_ioc.run(); });
+
+    io_context client_ioc;
+    websocket::stream<ip::tcp::socket> client(client_ioc);
+    client.next_layer().connect(acceptor.local_endpoint());
+    client.handshake("localhost", "/");
+
+    flat_buffer buffer;
+    client.read(buffer);
+    EXPECT_EQ(ConnectionRegistry::GetInstance().Size(), 1);
+
+    io_context control;
+    std::promise<bool> result;
+    ShutdownOptions options;
+    options.drain_timeout = std::chrono::seconds(5);
+    const auto shutdown = boost::make_shared<GracefulShutdown>(
+        control, options, [&result](const bool drained) { result.set_value(drained); });
+    shutdown->Start();
+    std::thread drainer([&control] { control.run(); });
+
+    // The client sees the close frame and answers it; the server connection
+    // then goes away and the drain completes.
+    error_code ec;
+    buffer.clear();
+    client.read(buffer, ec);
+    EXPECT_EQ(ec, websocket::error::closed);
+    EXPECT_EQ(client.reason().code, websocket::close_code::going_away);
+
+    EXPECT_TRUE(result.get_future().get());
+    EXPECT_EQ(ConnectionRegistry::GetInstance().Size(), 0);
+
+    drainer.join();
+    work.reset();
+    server_ioc.stop();
+    server.join();
+}
+
+TEST(GracefulShutdownTest, AbortFinishesWithoutDraining) {
+    io_context control;
+    std::optional<bool> drained;
+    const auto shutdown = boost::make_shared<GracefulShutdown>(
+        control, ShutdownOptions{}, [&drained](const bool value) { drained = value; });
+
+    shutdown->Abort();
+    shutdown->Abort();
+    control.run();
+
+    ASSERT_TRUE(drained.has_value());
+    EXPECT_FALSE(*drained);
+}
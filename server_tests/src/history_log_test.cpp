@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+#include "../../server/include/history_log.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    class HistoryLogTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            directory = fs::temp_directory_path() / ("history_log_test_" + std::to_string(::getpid()));
+            fs::remove_all(directory);
+        }
+
+        void TearDown() override {
+            fs::remove_all(directory);
+        }
+
+        HistoryLogOptions Options(const size_t segment_bytes = 64 * 1024 * 1024) const {
+            HistoryLogOptions options;
+            options.directory = directory.string();
+            options.segment_bytes = segment_bytes;
+            options.commit_window = std::chrono::milliseconds(0);
+            return options;
+        }
+
+        void Write(HistoryLog& log, const std::string& room, const std::vector<std::string>& texts) {
+            for (const auto& text : texts) {
+                log.Append(room, *MakeBroadcastMessage(text, WireProtocol::Json, "sender"));
+            }
+        }
+
+        std::vector<std::string> Payloads(const std::vector<RecoveredRoom>& rooms, const std::string& name) const {
+            std::vector<std::string> payloads;
+            for (const auto& room : rooms) {
+                if (room.name != name) continue;
+                for (const auto& message : room.messages) {
+                    payloads.push_back(message->Data());
+                }
+            }
+            return payloads;
+        }
+
+        size_t Segments() const {
+            size_t count = 0;
+            for (const auto& entry : fs::directory_iterator(directory)) {
+                count += entry.path().extension() == ".seg";
+            }
+            return count;
+        }
+
+        fs::path directory;
+    };
+}
+
+TEST_F(HistoryLogTest, ReplaysRoomsInWriteOrder) {
+    {
+        HistoryLog log(Options());
+        Write(log, "lobby", {"a", "b"});
+        Write(log, "games", {"x"});
+        Write(log, "lobby", {"c"});
+        log.Flush();
+        EXPECT_EQ(log.Written(), 4);
+    }
+
+    const auto rooms = HistoryLog::Replay(directory.string(), 10);
+    ASSERT_EQ(rooms.size(), 2);
+    EXPECT_EQ(Payloads(rooms, "lobby"), (std::vector<std::string>{"a", "b", "c"}));
+    EXPECT_EQ(Payloads(rooms, "games"), (std::vector<std::string>{"x"}));
+    EXPECT_EQ(rooms.front().messages.front()->Sender(), "sender");
+}
+
+TEST_F(HistoryLogTest, KeepsOnlyEachRoomsTailAcrossSegments) {
+    {
+        // Tiny segments force a new file for almost every batch.
+        HistoryLog log(Options(64));
+        for (int i = 0; i < 20; ++i) {
+            Write(log, "busy", {std::to_string(i)});
+            log.Flush();
+        }
+        Write(log, "quiet", {"only"});
+        log.Flush();
+    }
+    EXPECT_GT(Segments(), 1);
+
+    const auto rooms = HistoryLog::Replay(directory.string(), 3);
+    EXPECT_EQ(Payloads(rooms, "busy"), (std::vector<std::string>{"17", "18", "19"}));
+    EXPECT_EQ(Payloads(rooms, "quiet"), (std::vector<std::string>{"only"}));
+}
+
+TEST_F(HistoryLogTest, StopsAtTornTail) {
+    {
+        HistoryLog log(Options());
+        Write(log, "lobby", {"kept", "torn"});
+    }
+
+    // Simulate a crash in the middle of the last record: cut the segment and
+    // drop its index.
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        if (entry.path().extension() == ".seg") {
+            fs::resize_file(entry.path(), fs::file_size(entry.path()) - 2);
+        } else {
+            fs::remove(entry.path());
+        }
+    }
+
+    const auto rooms = HistoryLog::Replay(directory.string(), 10);
+    EXPECT_EQ(Payloads(rooms, "lobby"), (std::vector<std::string>{"kept"}));
+
+    // Reopening indexes the damaged segment and writes to a new one.
+    {
+        HistoryLog log(Options());
+        Write(log, "lobby", {"after"});
+    }
+    EXPECT_EQ(Segments(), 2);
+    EXPECT_EQ(Payloads(HistoryLog::Replay(directory.string(), 10), "lobby"), (std::vector<std::string>{"kept", "after"}));
+}
+
+TEST_F(HistoryLogTest, CorruptRecordIsSkipped) {
+    {
+        HistoryLog log(Options());
+        Write(log, "lobby", {"first", "damaged", "last"});
+    }
+
+    // Overwrite a byte of the middle payload; its header stays intact.
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        if (entry.path().extension() != ".seg") continue;
+        std::fstream segment(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(segment)), std::istreambuf_iterator<char>());
+        segment.seekp(static_cast<std::streamoff>(data.find("damaged")));
+        segment.put('D');
+    }
+
+    EXPECT_EQ(Payloads(HistoryLog::Replay(directory.string(), 10), "lobby"), (std::vector<std::string>{"first", "last"}));
+}
+
+TEST_F(HistoryLogTest, StagedHistoryIsTakenOnce) {
+    HistoryLog log(Options());
+    log.Stage({{"lobby", {MakeBroadcastMessage("restored")}}});
+
+    const auto messages = log.TakeRecovered("lobby");
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages.front()->Data(), "restored");
+    EXPECT_TRUE(log.TakeRecovered("lobby").empty());
+    EXPECT_TRUE(log.TakeRecovered("elsewhere").empty());
+}
+
+TEST_F(HistoryLogTest, RetentionDropsOldestSegments) {
+    {
+        auto options = Options(16);
+        options.max_segments = 2;
+        HistoryLog log(options);
+        for (int i = 0; i < 6; ++i) {
+            Write(log, "room", {std::to_string(i)});
+            log.Flush();
+        }
+    }
+
+    EXPECT_EQ(Segments(), 2);
+    EXPECT_EQ(Payloads(HistoryLog::Replay(directory.string(), 10), "room"), (std::vector<std::string>{"4", "5"}));
+}
+
+TEST_F(HistoryLogTest, MissingDirectoryReplaysNothing) {
+    EXPECT_TRUE(HistoryLog::Replay(directory.string(), 10).empty());
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+#include "../../server/include/io_engine.h"
+#include <boost/asio/post.hpp>
+#include <future>
+#include <latch>
+#include <set>
+#include <stdexcept>
+
+namespace {
+    IoEngineOptions Options(const size_t threads, const IoMode mode) {
+        IoEngineOptions options;
+        options.threads = threads;
+        options.mode = mode;
+        return options;
+    }
+}
+
+TEST(IoEngineTest, SharedModeRunsOneContextOnEveryThread) {
+    IoEngine engine(Options(3, IoMode::Shared));
+    ASSERT_EQ(engine.ContextCount(), 1);
+    engine.Start();
+
+    // Only completes if three threads run the context at the same time.
+    std::latch all_running(3);
+    std::promise<void> done;
+    std::atomic<int> finished{0};
+    for (int i = 0; i < 3; ++i) {
+        boost::asio::post(engine.Context(0), [&] {
+            all_running.arrive_and_wait();
+            if (++finished == 3) done.set_value();
+        });
+    }
+
+    EXPECT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    engine.Stop();
+}
+
+TEST(IoEngineTest, PerCoreModeGivesEachThreadItsOwnContext) {
+    IoEngine engine(Options(3, IoMode::PerCore));
+    ASSERT_EQ(engine.ContextCount(), 3);
+    engine.Start();
+
+    std::set<std::thread::id> threads;
+    for (size_t i = 0; i < engine.ContextCount(); ++i) {
+        std::promise<std::thread::id> ran_on;
+        boost::asio::post(engine.Context(i), [&ran_on] { ran_on.set_value(std::this_thread::get_id()); });
+        threads.insert(ran_on.get_future().get());
+    }
+
+    EXPECT_EQ(threads.size(), 3);
+    engine.Stop();
+}
+
+TEST(IoEngineTest, UsageMeasuresBusyThreads) {
+    IoEngine engine(Options(2, IoMode::PerCore));
+    EXPECT_TRUE(engine.Usage().empty());
+    engine.Start();
+
+    std::promise<void> done;
+    boost::asio::post(engine.Context(0), [&done] {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+        while (std::chrono::steady_clock::now() < until) {}
+        done.set_value();
+    });
+    done.get_future().wait();
+
+    const auto usage = engine.Usage();
+    ASSERT_EQ(usage.size(), 2);
+    EXPECT_GT(usage[0].busy_seconds, 0.1);
+    EXPECT_LT(usage[1].busy_seconds, 0.1);
+    EXPECT_GT(usage[0].Utilization(), usage[1].Utilization());
+    EXPECT_EQ(usage[1].context, 1);
+    EXPECT_EQ(usage[1].cpu, -1);
+
+    engine.Stop();
+    EXPECT_TRUE(engine.Usage().empty());
+}
+
+TEST(IoEngineTest, ThreadSurvivesThrowingHandler) {
+    IoEngine engine(Options(1, IoMode::Shared));
+    engine.Start();
+
+    boost::asio::post(engine.Context(0), [] { throw std::runtime_error("handler failed"); });
+    std::promise<void> ran;
+    boost::asio::post(engine.Context(0), [&ran] { ran.set_value(); });
+
+    EXPECT_EQ(ran.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    engine.Stop();
+}
+
+TEST(IoEngineTest, ReportsTheReactorAsioWasBuiltWith) {
+#if defined(SERVER_IO_URING)
+    EXPECT_STREQ(IoEngine::BackendName(), "io_uring");
+#elif defined(__linux__)
+    EXPECT_STREQ(IoEngine::BackendName(), "epoll");
+#elif defined(__APPLE__)
+    EXPECT_STREQ(IoEngine::BackendName(), "kqueue");
+#endif
+}
@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+#include "../../server/include/logger.h"
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace {
+    struct CapturedLines {
+        boost::mutex mutex;
+        std::string text;
+
+        LoggerOptions Options(const LogLevel level = LogLevel::Debug) {
+            LoggerOptions options;
+            options.level = level;
+            options.sink = [this](const std::string_view batch) {
+                boost::lock_guard guard(mutex);
+                text.append(batch);
+            };
+            return options;
+        }
+
+        std::string Text() {
+            boost::lock_guard guard(mutex);
+            return text;
+        }
+    };
+}
+
+TEST(LoggerTest, WritesStructuredRecords) {
+    CapturedLines lines;
+    Logger logger(lines.Options());
+
+    logger.Log(LogLevel::Warn, "WebSocket read error", {{"conn", 42}, {"room", "main hall"}, {"detail", "eof"}});
+    logger.Flush();
+
+    const std::string text = lines.Text();
+    EXPECT_NE(text.find("level=warn msg=\"WebSocket read error\" conn=42 room=\"main hall\" detail=eof\n"), std::string::npos);
+    EXPECT_EQ(text.rfind("ts=", 0), 0);
+}
+
+TEST(LoggerTest, FiltersBelowConfiguredLevel) {
+    CapturedLines lines;
+    Logger logger(lines.Options(LogLevel::Warn));
+
+    logger.Log(LogLevel::Info, "hidden");
+    logger.Log(LogLevel::Error, "shown");
+    logger.Flush();
+
+    EXPECT_EQ(lines.Text().find("hidden"), std::string::npos);
+    EXPECT_NE(lines.Text().find("shown"), std::string::npos);
+}
+
+TEST(LoggerTest, RateLimitSuppressesAndReports) {
+    CapturedLines lines;
+    auto options = lines.Options();
+    options.max_records_per_second = 2;
+    Logger logger(std::move(options));
+
+    for (int i = 0; i < 10; ++i) {
+        logger.Log(LogLevel::Error, "storm", {{"i", i}});
+    }
+    logger.Flush();
+
+    EXPECT_GE(logger.Suppressed(), 6);
+    EXPECT_LE(logger.Suppressed(), 8);
+    EXPECT_NE(lines.Text().find("msg=\"log records lost\""), std::string::npos);
+}
+
+TEST(LoggerTest, FullRingDropsInsteadOfBlocking) {
+    boost::mutex gate;
+    gate.lock();
+
+    LoggerOptions options;
+    options.capacity = 4;
+    options.max_records_per_second = 0;
+    options.sink = [&gate](std::string_view) { boost::lock_guard guard(gate); };
+    Logger logger(std::move(options));
+
+    for (int i = 0; i < 100; ++i) {
+        logger.Log(LogLevel::Error, "flood");
+    }
+    EXPECT_GT(logger.Dropped(), 0);
+
+    gate.unlock();
+    logger.Flush();
+}
+
+TEST(LoggerTest, TruncatesOversizedRecords) {
+    CapturedLines lines;
+    Logger logger(lines.Options());
+
+    logger.Log(LogLevel::Info, std::string(Logger::kMaxRecordBytes * 2, 'x'));
+    logger.Flush();
+
+    EXPECT_LT(lines.Text().size(), Logger::kMaxRecordBytes + 100);
+}
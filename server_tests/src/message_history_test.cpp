@@ -0,0 +1,110 @@
+#include "gtest/gtest.h"
+#include "../../server/include/message_history.h"
+#include <string>
+
+namespace {
+    std::vector<std::string> Payloads(const HistorySlice& slice) {
+        std::vector<std::string> payloads;
+        for (const auto& entry : slice) {
+            payloads.push_back(entry.message->Data());
+        }
+        return payloads;
+    }
+}
+
+TEST(MessageHistoryTest, AssignsIncreasingSequences) {
+    MessageHistory history;
+
+    EXPECT_EQ(history.Append(MakeBroadcastMessage("a")), 1);
+    EXPECT_EQ(history.Append(MakeBroadcastMessage("b")), 2);
+    EXPECT_EQ(history.LastSequence(), 2);
+    EXPECT_EQ(history.Size(), 2);
+}
+
+TEST(MessageHistoryTest, EvictsByMessageCount) {
+    MessageHistory history({3, 1024});
+    for (const auto* text : {"1", "2", "3", "4", "5"}) {
+        history.Append(MakeBroadcastMessage(text));
+    }
+
+    EXPECT_EQ(history.Size(), 3);
+    EXPECT_EQ(history.FirstSequence(), 3);
+    EXPECT_EQ(Payloads(history.Tail(10)), (std::vector<std::string>{"3", "4", "5"}));
+}
+
+TEST(MessageHistoryTest, EvictsByBytes) {
+    MessageHistory history({100, 10});
+    history.Append(MakeBroadcastMessage("aaaa"));
+    history.Append(MakeBroadcastMessage("bbbb"));
+    history.Append(MakeBroadcastMessage("cccc"));
+
+    EXPECT_EQ(history.Bytes(), 8);
+    EXPECT_EQ(Payloads(history.Tail(10)), (std::vector<std::string>{"bbbb", "cccc"}));
+}
+
+TEST(MessageHistoryTest, TailReturnsLastN) {
+    MessageHistory history({4, 1024});
+    for (int i = 0; i < 10; ++i) {
+        history.Append(MakeBroadcastMessage(std::to_string(i)));
+    }
+
+    const auto tail = history.Tail(2);
+    ASSERT_EQ(tail.size(), 2);
+    EXPECT_EQ(tail[0].sequence, 9);
+    EXPECT_EQ(Payloads(tail), (std::vector<std::string>{"8", "9"}));
+}
+
+TEST(MessageHistoryTest, PagesWithCursor) {
+    MessageHistory history({5, 1024});
+    for (int i = 1; i <= 7; ++i) {
+        history.Append(MakeBroadcastMessage(std::to_string(i)));
+    }
+
+    const auto first_page = history.Page(0, 2);
+    EXPECT_EQ(Payloads(first_page), (std::vector<std::string>{"3", "4"}));
+
+    const auto second_page = history.Page(first_page.back().sequence, 2);
+    EXPECT_EQ(Payloads(second_page), (std::vector<std::string>{"5", "6"}));
+
+    const auto last_page = history.Page(second_page.back().sequence, 2);
+    EXPECT_EQ(Payloads(last_page), (std::vector<std::string>{"7"}));
+    EXPECT_TRUE(history.Page(7, 2).empty());
+}
+
+TEST(MessageHistoryTest, SlicesShareStoredMessages) {
+    MessageHistory history;
+    const auto message = MakeBroadcastMessage("shared");
+    history.Append(message);
+
+    const auto slice = history.Tail(1);
+    EXPECT_EQ(slice[0].message.get(), message.get());
+}
+
+TEST(MessageHistoryTest, GrowsAfterWrapWithoutLosingOrder) {
+    MessageHistory history({4, 12});
+    history.Append(MakeBroadcastMessage("aaaa"));
+    history.Append(MakeBroadcastMessage("bbbb"));
+    history.Append(MakeBroadcastMessage("cccc"));
+    history.Append(MakeBroadcastMessage("dd"));
+    history.Append(MakeBroadcastMessage("e"));
+    history.Append(MakeBroadcastMessage("f"));
+
+    EXPECT_EQ(Payloads(history.Tail(10)), (std::vector<std::string>{"cccc", "dd", "e", "f"}));
+}
+
+TEST(MessageHistoryTest, OversizedMessageKeepsRetainedEntries) {
+    MessageHistory history({10, 8});
+    history.Append(MakeBroadcastMessage("a"));
+    history.Append(MakeBroadcastMessage("b"));
+    EXPECT_EQ(history.Append(MakeBroadcastMessage("far too large")), 3);
+    history.Append(MakeBroadcastMessage("c"));
+
+    EXPECT_EQ(Payloads(history.Tail(10)), (std::vector<std::string>{"a", "b", "c"}));
+    EXPECT_EQ(history.Bytes(), 3);
+
+    // Paging steps over the skipped sequence.
+    EXPECT_EQ(Payloads(history.Page(1, 10)), (std::vector<std::string>{"b", "c"}));
+    EXPECT_EQ(Payloads(history.Page(2, 10)), (std::vector<std::string>{"c"}));
+    EXPECT_EQ(Payloads(history.Page(3, 10)), (std::vector<std::string>{"c"}));
+    EXPECT_TRUE(history.Page(4, 10).empty());
+}
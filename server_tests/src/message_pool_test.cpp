@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include "../../server/include/message_pool.h"
+#include <thread>
+#include <vector>
+
+TEST(MessagePoolTest, AcquireCopiesPayloadAndSender) {
+    const auto message = MessagePool::Acquire("hello", WireProtocol::Json, "alice");
+
+    EXPECT_EQ(message->Data(), "hello");
+    EXPECT_EQ(message->Encoding(), WireProtocol::Json);
+    EXPECT_EQ(message->UseCount(), 1);
+}
+
+TEST(MessagePoolTest, ReleasedMessagesAreReused) {
+    const BroadcastMessage* first;
+    {
+        const auto message = MessagePool::Acquire("first payload", WireProtocol::Json, "alice");
+        first = message.get();
+    }
+    const size_t pooled = MessagePool::PooledOnThisThread();
+    EXPECT_GE(pooled, 1);
+
+    const auto reused = MessagePool::Acquire("second", WireProtocol::Json, "bob");
+    EXPECT_EQ(reused.get(), first);
+    EXPECT_EQ(reused->Data(), "second");
+    EXPECT_EQ(MessagePool::PooledOnThisThread(), pooled - 1);
+}
+
+TEST(MessagePoolTest, RecycledMessageDropsStaleTranscoding) {
+    {
+        const auto message = MessagePool::Acquire("one", WireProtocol::Json, "alice");
+        message->BufferFor(WireProtocol::Binary);
+    }
+
+    const auto message = MessagePool::Acquire("two", WireProtocol::Json, "bob");
+    const auto buffer = message->BufferFor(WireProtocol::Binary);
+    const std::string_view binary(static_cast<const char*>(buffer.data()), buffer.size());
+
+    EXPECT_EQ(binary, WireCodec::EncodeRoomMessage("bob", "two"));
+}
+
+TEST(MessagePoolTest, OversizedMessagesAreNotRetained) {
+    const size_t pooled = MessagePool::PooledOnThisThread();
+    {
+        const std::string large(MessagePool::kMaxPooledCapacity + 1, 'x');
+        const auto message = MessagePool::Acquire(large, WireProtocol::Json, "alice");
+    }
+    EXPECT_LE(MessagePool::PooledOnThisThread(), pooled);
+}
+
+TEST(MessagePoolTest, MessagesReleasedElsewhereReturnToTheirOwner) {
+    auto message = MessagePool::Acquire("fan-out", WireProtocol::Json, "alice");
+    const BroadcastMessage* original = message.get();
+
+    std::thread([released = std::move(message)]() mutable { released.reset(); }).join();
+
+    // Drain anything this thread pooled before, then the returned message is
+    // the next one handed out.
+    std::vector<BroadcastMessagePtr> held;
+    while (MessagePool::PooledOnThisThread() > 0) {
+        held.push_back(MessagePool::Acquire("", WireProtocol::Json, ""));
+    }
+    EXPECT_EQ(MessagePool::Acquire("again", WireProtocol::Json, "bob").get(), original);
+}
+
+TEST(MessagePoolTest, ReleaseAfterOwnerExitFreesTheMessage) {
+    BroadcastMessagePtr orphan;
+    std::thread([&orphan] { orphan = MessagePool::Acquire("orphan", WireProtocol::Json, "alice"); }).join();
+
+    EXPECT_EQ(orphan->Data(), "orphan");
+    orphan.reset();
+}
@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+#include "../../server/include/outbound_queue.h"
+
+TEST(OutboundQueueTest, FirstPushStartsWrite) {
+    OutboundQueue queue(1024, OverflowPolicy::DropNewest);
+
+    EXPECT_EQ(queue.Push(MakeBroadcastMessage("first")), OutboundQueue::PushResult::StartWrite);
+    EXPECT_EQ(queue.Push(MakeBroadcastMessage("second")), OutboundQueue::PushResult::Queued);
+    EXPECT_TRUE(queue.IsWriting());
+    EXPECT_EQ(queue.QueuedBytes(), 11);
+}
+
+TEST(OutboundQueueTest, DrainsInOrderAndStopsWriting) {
+    OutboundQueue queue(1024, OverflowPolicy::DropNewest);
+    queue.Push(MakeBroadcastMessage("a"));
+    queue.Push(MakeBroadcastMessage("b"));
+
+    ASSERT_NE(queue.Front(), nullptr);
+    EXPECT_EQ(queue.Front()->Data(), "a");
+    queue.Push(MakeBroadcastMessage("c"));
+    EXPECT_TRUE(queue.PopFront());
+    EXPECT_EQ(queue.Front()->Data(), "b");
+    EXPECT_TRUE(queue.PopFront());
+    EXPECT_EQ(queue.Front()->Data(), "c");
+    EXPECT_FALSE(queue.PopFront());
+
+    EXPECT_FALSE(queue.IsWriting());
+    EXPECT_EQ(queue.QueuedBytes(), 0);
+    EXPECT_EQ(queue.Push(MakeBroadcastMessage("d")), OutboundQueue::PushResult::StartWrite);
+}
+
+TEST(OutboundQueueTest, DropNewestRejectsWhenFull) {
+    OutboundQueue queue(8, OverflowPolicy::DropNewest);
+    queue.Push(MakeBroadcastMessage("12345"));
+
+    EXPECT_EQ(queue.Push(MakeBroadcastMessage("6789")), OutboundQueue::PushResult::Dropped);
+    EXPECT_EQ(queue.QueuedMessages(), 1);
+}
+
+TEST(OutboundQueueTest, DropOldestEvictsPendingOnly) {
+    OutboundQueue queue(8, OverflowPolicy::DropOldest);
+    queue.Push(MakeBroadcastMessage("abc"));
+    queue.Front();
+    queue.Push(MakeBroadcastMessage("def"));
+
+    EXPECT_EQ(queue.Push(MakeBroadcastMessage("ghi")), OutboundQueue::PushResult::Queued);
+    EXPECT_EQ(queue.Front()->Data(), "abc");
+    EXPECT_TRUE(queue.PopFront());
+    EXPECT_EQ(queue.Front()->Data(), "ghi");
+}
+
+TEST(OutboundQueueTest, DisconnectPolicyReportsOverflow) {
+    OutboundQueue queue(4, OverflowPolicy::Disconnect);
+    queue.Push(MakeBroadcastMessage("1234"));
+
+    EXPECT_EQ(queue.Push(MakeBroadcastMessage("5")), OutboundQueue::PushResult::Overflow);
+}
+
+TEST(OutboundQueueTest, ClosedQueueDropsEverything) {
+    OutboundQueue queue(1024, OverflowPolicy::DropNewest);
+    queue.Push(MakeBroadcastMessage("in flight"));
+    queue.Front();
+    queue.Push(MakeBroadcastMessage("pending"));
+    queue.Close();
+
+    EXPECT_EQ(queue.Push(MakeBroadcastMessage("late")), OutboundQueue::PushResult::Dropped);
+    EXPECT_EQ(queue.QueuedMessages(), 1);
+}
+
+TEST(OutboundQueueTest, SealedQueueDrainsWhatIsQueued) {
+    OutboundQueue queue(1024, OverflowPolicy::DropNewest);
+    queue.Push(MakeBroadcastMessage("in flight"));
+    queue.Front();
+    queue.Push(MakeBroadcastMessage("pending"));
+    queue.Seal();
+
+    EXPECT_EQ(queue.Push(MakeBroadcastMessage("late")), OutboundQueue::PushResult::Dropped);
+    EXPECT_EQ(queue.QueuedMessages(), 2);
+
+    EXPECT_TRUE(queue.PopFront());
+    EXPECT_EQ(queue.Front()->Data(), "pending");
+    EXPECT_FALSE(queue.PopFront());
+    EXPECT_FALSE(queue.IsWriting());
+}
+
+TEST(OutboundQueueTest, QueuesShareTheBroadcastInstance) {
+    OutboundQueue first(1024, OverflowPolicy::DropNewest);
+    OutboundQueue second(1024, OverflowPolicy::DropNewest);
+    const auto message = MakeBroadcastMessage("shared payload");
+
+    first.Push(message);
+    second.Push(message);
+
+    EXPECT_EQ(first.Front(), message.get());
+    EXPECT_EQ(second.Front(), message.get());
+    EXPECT_EQ(message->UseCount(), 3);
+}
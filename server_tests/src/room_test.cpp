@@ -73,4 +73,95 @@ TEST_F(RoomTest, UserListManagement) {
 
     vip_room.RemoveConnection(user1);
     EXPECT_THAT(vip_room.GetActiveUsers().size(), 1);
-}
\ No newline at end of file
+}
+
+TEST_F(RoomTest, RemoveByHandleKeepsOtherHandlesValid) {
+    Room lounge("handles");
+    std::vector<boost::shared_ptr<MockSocketConnection>> users;
+    std::vector<Room::MemberHandle> handles;
+
+    for (int i = 0; i < 4; ++i) {
+        users.push_back(boost::make_shared<MockSocketConnection>());
+        handles.push_back(lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(users.back())));
+    }
+
+    // Removing the first member moves the last one into its slot.
+    lounge.RemoveConnection(handles[0]);
+    EXPECT_EQ(lounge.ConnectionCount(), 3);
+
+    lounge.RemoveConnection(handles[3]);
+    lounge.RemoveConnection(handles[3]);
+    EXPECT_EQ(lounge.ConnectionCount(), 2);
+
+    lounge.RemoveConnection(Room::kNoMember);
+    EXPECT_EQ(lounge.ConnectionCount(), 2);
+
+    // Freed handles are reused and stay independent of the survivors.
+    const auto reused = lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(users[0]));
+    EXPECT_EQ(lounge.ConnectionCount(), 3);
+    lounge.RemoveConnection(handles[1]);
+    lounge.RemoveConnection(handles[2]);
+    EXPECT_EQ(lounge.ConnectionCount(), 1);
+    lounge.RemoveConnection(reused);
+    EXPECT_EQ(lounge.ConnectionCount(), 0);
+}
+
+TEST_F(RoomTest, StaleHandleOfSweptMemberLeavesSlotReuserAlone) {
+    Room lounge("stale");
+    const auto stayer = boost::make_shared<MockSocketConnection>();
+    lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(stayer));
+
+    auto departed = boost::make_shared<MockSocketConnection>();
+    const auto stale = lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(departed));
+
+    // The connection dies, and a sweep frees its slot before its destructor
+    // gets to remove it by handle.
+    departed.reset();
+    const auto leaver = boost::make_shared<MockSocketConnection>();
+    lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(leaver));
+    lounge.RemoveConnection(boost::static_pointer_cast<SocketConnection>(leaver));
+    ASSERT_EQ(lounge.ConnectionCount(), 1);
+
+    const auto newcomer = boost::make_shared<MockSocketConnection>();
+    const auto fresh = lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(newcomer));
+    EXPECT_EQ(static_cast<uint32_t>(fresh), static_cast<uint32_t>(stale));
+
+    lounge.RemoveConnection(stale);
+    EXPECT_EQ(lounge.ConnectionCount(), 2);
+
+    lounge.RemoveConnection(fresh);
+    EXPECT_EQ(lounge.ConnectionCount(), 1);
+}
+
+TEST_F(RoomTest, ExpiredMembersAreSweptOnGrowth) {
+    Room lounge("sweep");
+    const auto survivor = boost::make_shared<MockSocketConnection>();
+    lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(survivor));
+
+    for (int i = 0; i < 256; ++i) {
+        const auto transient = boost::make_shared<MockSocketConnection>();
+        lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(transient));
+    }
+
+    EXPECT_LT(lounge.ConnectionCount(), 128);
+    EXPECT_THAT(lounge.GetActiveUsers(), SizeIs(1));
+}
+
+TEST_F(RoomTest, UserListSeesMembershipChangesBetweenBroadcasts) {
+    Room lounge("snapshots");
+    const auto first = boost::make_shared<MockSocketConnection>();
+    const auto second = boost::make_shared<MockSocketConnection>();
+
+    const auto first_handle = lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(first));
+    lounge.DistributeMessage("hello");
+    EXPECT_THAT(lounge.GetActiveUsers(), SizeIs(1));
+
+    lounge.AddConnection(boost::static_pointer_cast<SocketConnection>(second));
+    EXPECT_THAT(lounge.GetActiveUsers(), SizeIs(2));
+
+    lounge.RemoveConnection(first_handle);
+    lounge.DistributeMessage("again");
+    EXPECT_THAT(lounge.GetActiveUsers(), SizeIs(1));
+    EXPECT_EQ(lounge.MessagesDistributed(), 2);
+    EXPECT_THAT(lounge.GetMessageHistory(), ElementsAre("hello", "again"));
+}
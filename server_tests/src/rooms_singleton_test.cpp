@@ -3,6 +3,7 @@
 #include "../../server/include/connection_acceptor.h"
 #include <vector>
 #include <stdexcept>
+#include <thread>
 
 class RoomsSingletonTest : public ::testing::Test {
 protected:
@@ -78,4 +79,53 @@ TEST_F(RoomsSingletonTest, OverwriteExistingRoom) {
 
     rooms->RegisterRoom("room", room1);
     EXPECT_THROW(rooms->RegisterRoom("room", room2), std::runtime_error);
-}
\ No newline at end of file
+}
+
+TEST_F(RoomsSingletonTest, RoomCountTracksRegistrations) {
+    rooms->RegisterRoom("room1", boost::make_shared<Room>("room1"));
+    rooms->RegisterRoom("room2", boost::make_shared<Room>("room2"));
+    rooms->UnregisterRoom("room1");
+    rooms->UnregisterRoom("room1");
+
+    EXPECT_EQ(rooms->RoomCount(), 1);
+}
+
+TEST_F(RoomsSingletonTest, ConcurrentRegisterAndFetch) {
+    constexpr int kThreads = 4;
+    constexpr int kRoomsPerThread = 200;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([this, t] {
+            for (int i = 0; i < kRoomsPerThread; ++i) {
+                const auto name = "room_" + std::to_string(t) + "_" + std::to_string(i);
+                rooms->RegisterRoom(name, boost::make_shared<Room>(name));
+                EXPECT_NE(rooms->FetchRoom(name), nullptr);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    EXPECT_EQ(rooms->RoomCount(), kThreads * kRoomsPerThread);
+    EXPECT_EQ(rooms->GetAllRoomNames().size(), kThreads * kRoomsPerThread);
+}
+
+TEST_F(RoomsSingletonTest, RoomListSnapshotIsReusedUntilChange) {
+    rooms->RegisterRoom("room1", boost::make_shared<Room>("room1"));
+
+    const auto first = rooms->GetRoomListSnapshot();
+    const auto second = rooms->GetRoomListSnapshot();
+    EXPECT_EQ(first.payload, second.payload);
+    EXPECT_EQ(first.version, rooms->Version());
+
+    rooms->RegisterRoom("room2", boost::make_shared<Room>("room2"));
+    const auto third = rooms->GetRoomListSnapshot();
+    EXPECT_NE(third.payload, first.payload);
+    EXPECT_GT(third.version, first.version);
+
+    const auto listing = nlohmann::json::parse(third.payload->Data());
+    EXPECT_EQ(listing["rooms"].size(), 2);
+    EXPECT_EQ(listing["version"], third.version);
+}
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "../../server/include/server_metrics.h"
+#include "../../server/include/metrics_endpoint.h"
+#include "../../server/include/rooms_singleton.h"
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(ServerMetricsTest, CountersSumAcrossThreads) {
+    const auto before = ServerMetrics::Collect().Get(Metric::MessagesIn);
+
+    ServerMetrics::Add(Metric::MessagesIn);
+    std::thread([] { ServerMetrics::Add(Metric::MessagesIn, 2); }).join();
+
+    EXPECT_EQ(ServerMetrics::Collect().Get(Metric::MessagesIn), before + 3);
+}
+
+TEST(ServerMetricsTest, GaugesAcceptNegativeDeltasFromOtherThreads) {
+    const auto before = ServerMetrics::Collect().Get(Metric::QueuedBytes);
+
+    ServerMetrics::Add(Metric::QueuedBytes, 100);
+    std::thread([] { ServerMetrics::Add(Metric::QueuedBytes, -60); }).join();
+
+    EXPECT_EQ(ServerMetrics::Collect().Get(Metric::QueuedBytes), before + 40);
+}
+
+TEST(ServerMetricsTest, LatenciesLandInTheirBucket) {
+    const auto before = ServerMetrics::Collect().Get(LatencyMetric::AcceptToHandshake);
+
+    ServerMetrics::Observe(LatencyMetric::AcceptToHandshake, 40us);
+    ServerMetrics::Observe(LatencyMetric::AcceptToHandshake, 100us);
+    ServerMetrics::Observe(LatencyMetric::AcceptToHandshake, 10s);
+
+    const auto after = ServerMetrics::Collect().Get(LatencyMetric::AcceptToHandshake);
+    EXPECT_EQ(after.buckets[0], before.buckets[0] + 1);
+    EXPECT_EQ(after.buckets[1], before.buckets[1] + 1);
+    EXPECT_EQ(after.buckets.back(), before.buckets.back() + 1);
+    EXPECT_EQ(after.Count(), before.Count() + 3);
+    EXPECT_EQ(after.sum - before.sum, 40us + 100us + 10s);
+}
+
+TEST(ServerMetricsTest, RenderExportsCountersHistogramsAndRooms) {
+    const auto rooms = RoomsSingleton::GetInstance();
+    rooms->RegisterRoom("metrics_room", boost::make_shared<Room>("metrics_room"));
+
+    const std::string text = MetricsEndpoint::Render();
+    rooms->UnregisterRoom("metrics_room");
+
+    EXPECT_NE(text.find("# TYPE chat_accepts_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("chat_receive_to_fanout_seconds_bucket{le=\"+Inf\"}"), std::string::npos);
+    EXPECT_NE(text.find("chat_room_connections{room=\"metrics_room\"} 0\n"), std::string::npos);
+}
+
+TEST(ServerMetricsTest, RenderCapsPerRoomSeries) {
+    const auto rooms = RoomsSingleton::GetInstance();
+    std::vector<std::string> names;
+    for (size_t i = 0; i <= MetricsEndpoint::kMaxRoomSeries; ++i) {
+        names.push_back("capped_room_" + std::to_string(i));
+        rooms->RegisterRoom(names.back(), boost::make_shared<Room>(names.back()));
+    }
+
+    const std::string text = MetricsEndpoint::Render();
+    for (const auto& name : names) {
+        rooms->UnregisterRoom(name);
+    }
+
+    size_t series = 0;
+    for (size_t at = text.find("\nchat_room_connections{"); at != std::string::npos;
+         at = text.find("\nchat_room_connections{", at + 1)) {
+        ++series;
+    }
+    EXPECT_EQ(series, MetricsEndpoint::kMaxRoomSeries);
+    EXPECT_NE(text.find("\nchat_room_members "), std::string::npos);
+}
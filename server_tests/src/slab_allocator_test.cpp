@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+#include "../../server/include/slab_allocator.h"
+#include <thread>
+#include <vector>
+
+TEST(SlabAllocatorTest, FreedBlockIsReusedBySameSizeClass) {
+    if (!SlabAllocator::Enabled()) GTEST_SKIP();
+
+    void* first = SlabAllocator::Allocate(100);
+    SlabAllocator::Deallocate(first, 100);
+
+    const auto before = SlabAllocator::GetStats();
+    void* second = SlabAllocator::Allocate(120);
+    const auto after = SlabAllocator::GetStats();
+
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(after.hits, before.hits + 1);
+    SlabAllocator::Deallocate(second, 120);
+}
+
+TEST(SlabAllocatorTest, OversizedRequestsBypassTheSlab) {
+    if (!SlabAllocator::Enabled()) GTEST_SKIP();
+
+    const auto before = SlabAllocator::GetStats();
+    void* block = SlabAllocator::Allocate(SlabAllocator::kMaxBlock + 1);
+    SlabAllocator::Deallocate(block, SlabAllocator::kMaxBlock + 1);
+    const auto after = SlabAllocator::GetStats();
+
+    EXPECT_EQ(after.oversized, before.oversized + 1);
+    EXPECT_EQ(after.hits, before.hits);
+}
+
+TEST(SlabAllocatorTest, StatsSurviveThreadExit) {
+    if (!SlabAllocator::Enabled()) GTEST_SKIP();
+
+    const auto before = SlabAllocator::GetStats();
+    std::thread([] {
+        void* block = SlabAllocator::Allocate(64);
+        SlabAllocator::Deallocate(block, 64);
+        block = SlabAllocator::Allocate(64);
+        SlabAllocator::Deallocate(block, 64);
+    }).join();
+    const auto after = SlabAllocator::GetStats();
+
+    EXPECT_GE(after.misses, before.misses + 1);
+    EXPECT_GE(after.hits, before.hits + 1);
+}
+
+TEST(SlabAllocatorTest, BlockFreedElsewhereReturnsToItsOwner) {
+    if (!SlabAllocator::Enabled()) GTEST_SKIP();
+
+    std::thread([] {
+        void* block = SlabAllocator::Allocate(200);
+        std::thread([block] {
+            SlabAllocator::Deallocate(block, 200);
+        }).join();
+
+        EXPECT_EQ(SlabAllocator::Allocate(200), block);
+        SlabAllocator::Deallocate(block, 200);
+    }).join();
+}
+
+namespace {
+    struct AllocatesOnExit {
+        ~AllocatesOnExit() {
+            void* block = SlabAllocator::Allocate(64);
+            SlabAllocator::Deallocate(block, 64);
+        }
+    };
+}
+
+TEST(SlabAllocatorTest, AllocationsAfterSlabTeardownBypassIt) {
+    if (!SlabAllocator::Enabled()) GTEST_SKIP();
+
+    const auto before = SlabAllocator::GetStats();
+    std::thread([] {
+        // Constructed before the slab, so destroyed after it.
+        static thread_local AllocatesOnExit late;
+        (void)&late;
+        SlabAllocator::Deallocate(SlabAllocator::Allocate(64), 64);
+    }).join();
+    const auto after = SlabAllocator::GetStats();
+
+    EXPECT_EQ(after.after_teardown, before.after_teardown + 1);
+}
+
+TEST(SlabAllocatorTest, PooledAllocatorBacksStandardContainers) {
+    std::vector<int, PooledAllocator<int>> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+
+    EXPECT_EQ(values.size(), 1000);
+    EXPECT_EQ(values.back(), 999);
+}
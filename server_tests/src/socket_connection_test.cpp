@@ -2,6 +2,7 @@
 #include "gmock/gmock.h"
 #include "../../server/include/socket_connection.h"
 #include "../../server/include/rooms_singleton.h"
+#include "../../server/include/server_metrics.h"
 #include "mock_socket_connection.cpp"
 
 class SocketConnectionTest : public ::testing::Test {
@@ -74,3 +75,212 @@ TEST_F(SocketConnectionTest, BroadcastMessage) {
     ASSERT_EQ(messages.size(), 1);
     EXPECT_NE(messages[0].find("Hello, world!"), std::string::npos);
 }
+
+namespace {
+    // One SocketConnection with the given options, served on a background
+    // thread, and a client that has completed the handshake with it.
+    class LoopbackConnection {
+    public:
+        explicit LoopbackConnection(
+            const ConnectionOptions& options,
+            const bool client_deflate = false,
+            const std::string_view subprotocol = {}
+        )
+            : acceptor_(ioc_, ip::tcp::endpoint(ip::address_v4::loopback(), 0)),
+              client_(client_ioc_) {
+            acceptor_.async_accept([this, options](const error_code& ec, ip::tcp::socket socket) {
+                if (!ec) boost::make_shared<SocketConnection>(std::move(socket), options)->InitializeWebsocket();
+            });
+            server_ = std::thread([this] { ioc_.run(); });
+
+            if (client_deflate) {
+                websocket::permessage_deflate deflate;
+                deflate.client_enable = true;
+                client_.set_option(deflate);
+            }
+            if (!subprotocol.empty()) {
+                client_.set_option(websocket::stream_base::decorator(
+                    [subprotocol = std::string(subprotocol)](websocket::request_type& request) {
+                        request.set(http::field::sec_websocket_protocol, subprotocol);
+                    }));
+                client_.binary(subprotocol == WireCodec::kBinarySubprotocol);
+            }
+            client_.next_layer().connect(acceptor_.local_endpoint());
+            client_.handshake(response_, "localhost", "/");
+        }
+
+        ~LoopbackConnection() {
+            client_.next_layer().close();
+            ioc_.stop();
+            server_.join();
+        }
+
+        const websocket::response_type& Response() const {
+            return response_;
+        }
+
+        std::string Read() {
+            flat_buffer frame;
+            client_.read(frame);
+            return buffers_to_string(frame.data());
+        }
+
+        void Write(const std::string& text) {
+            client_.write(boost::asio::buffer(text));
+        }
+
+        // Reads until the server closes the connection and returns its reason.
+        websocket::close_reason ReadUntilClosed() {
+            flat_buffer frame;
+            error_code ec;
+            while (!ec) {
+                frame.clear();
+                client_.read(frame, ec);
+            }
+            return client_.reason();
+        }
+
+    private:
+        io_context ioc_;
+        ip::tcp::acceptor acceptor_;
+        std::thread server_;
+        io_context client_ioc_;
+        websocket::stream<ip::tcp::socket> client_;
+        websocket::response_type response_;
+    };
+
+    // The client's handshake response and the first message the server sent.
+    std::pair<websocket::response_type, std::string> HandshakeWith(const ConnectionOptions& options) {
+        LoopbackConnection connection(options, true);
+        std::string first = connection.Read();
+        return {connection.Response(), first};
+    }
+}
+
+TEST_F(SocketConnectionTest, NegotiatesDeflateWhenEnabled) {
+    ConnectionOptions options;
+    options.deflate.enabled = true;
+    options.deflate.window_bits = 12;
+
+    const auto [response, first] = HandshakeWith(options);
+    const std::string extensions(response[http::field::sec_websocket_extensions]);
+
+    EXPECT_NE(extensions.find("permessage-deflate"), std::string::npos);
+    EXPECT_NE(extensions.find("server_no_context_takeover"), std::string::npos);
+    EXPECT_NE(extensions.find("server_max_window_bits=12"), std::string::npos);
+    EXPECT_NE(first.find("rooms"), std::string::npos);
+}
+
+TEST_F(SocketConnectionTest, DeflateIsOffByDefault) {
+    const auto [response, first] = HandshakeWith({});
+
+    EXPECT_EQ(response[http::field::sec_websocket_extensions], "");
+    EXPECT_NE(first.find("rooms"), std::string::npos);
+}
+
+TEST_F(SocketConnectionTest, PausesReadsOverInboundLimit) {
+    ConnectionOptions options;
+    options.inbound.messages = {.per_second = 20, .burst = 1};
+
+    LoopbackConnection connection(options);
+    connection.Read();
+    connection.Write(R"({"operation":"create","roomName":"limited","userName":"flooder"})");
+
+    const auto pauses_before = ServerMetrics::Collect().Get(Metric::ReadPauses);
+    const auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        connection.Write("m" + std::to_string(i));
+    }
+
+    // The sender is a member of its own room, so every accepted message comes
+    // back. The burst covers the first; each later one pauses reads for the
+    // 50ms the bucket needs to refill.
+    int echoed = 0;
+    while (echoed < 4) {
+        echoed += connection.Read() == "m" + std::to_string(echoed);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+
+    EXPECT_GE(elapsed, std::chrono::milliseconds(140));
+    EXPECT_EQ(ServerMetrics::Collect().Get(Metric::ReadPauses), pauses_before + 3);
+}
+
+TEST_F(SocketConnectionTest, BatchesBroadcastsUpToCapOrWindow) {
+    ConnectionOptions options;
+    options.room.batch = {.window = std::chrono::milliseconds(100), .max_messages = 3};
+
+    LoopbackConnection connection(options);
+    connection.Read();
+    connection.Write(R"({"operation":"create","roomName":"batched","userName":"u"})");
+
+    const auto message = [](const int i) {
+        return R"({"username":"u","message":")" + std::to_string(i) + R"("})";
+    };
+    const auto next_broadcast = [&] {
+        std::string text;
+        do {
+            text = connection.Read();
+        } while (text.find(R"("username":"u")") == std::string::npos);
+        return text;
+    };
+
+    // Three messages fill the batch and go out at once as one array.
+    for (int i = 0; i < 3; ++i) {
+        connection.Write(message(i));
+    }
+    EXPECT_EQ(next_broadcast(), "[" + message(0) + "," + message(1) + "," + message(2) + "]");
+
+    // A lone message waits out the window and is sent as itself.
+    const auto sent = std::chrono::steady_clock::now();
+    connection.Write(message(3));
+    EXPECT_EQ(next_broadcast(), message(3));
+    EXPECT_GE(std::chrono::steady_clock::now() - sent, std::chrono::milliseconds(90));
+
+    // History keeps the messages, not the batches.
+    EXPECT_EQ(RoomsSingleton::GetInstance()->FetchRoom("batched")->GetMessageHistory().size(), 4);
+}
+
+TEST_F(SocketConnectionTest, DeliversCompressedBroadcastsAlongsidePings) {
+    ConnectionOptions options;
+    options.deflate.enabled = true;
+    options.deflate.window_bits = 12;
+    options.ping_interval = std::chrono::milliseconds(1);
+
+    LoopbackConnection connection(options, true);
+    connection.Read();
+    connection.Write(R"({"operation":"create","roomName":"deflated","userName":"u"})");
+
+    // Long enough for the 16-bit length form; Beast inflates each frame and
+    // rejects any whose bytes were interleaved with a ping.
+    const auto message = [](const int i) {
+        return std::to_string(i) + std::string(300, 'x');
+    };
+    for (int i = 0; i < 50; ++i) {
+        connection.Write(message(i));
+    }
+
+    int received = 0;
+    while (received < 50) {
+        const auto text = connection.Read();
+        if (text.find("rooms") != std::string::npos) continue;
+        ASSERT_EQ(text, message(received));
+        ++received;
+    }
+}
+
+TEST_F(SocketConnectionTest, ClosesBinaryConnectionThatSpoofsItsSender) {
+    LoopbackConnection connection({}, false, WireCodec::kBinarySubprotocol);
+    connection.Read();
+    connection.Write(WireCodec::EncodeRoomCommand({"create", "spoofed", "mallory"}));
+
+    // A frame carrying the user's own name is relayed back to it.
+    const auto own = WireCodec::EncodeRoomMessage("mallory", "hi");
+    connection.Write(own);
+    std::string relayed;
+    do {
+        relayed = connection.Read();
+    } while (relayed != own);
+
+    connection.Write(WireCodec::EncodeRoomMessage("alice", "it's me, alice"));
+    EXPECT_EQ(connection.ReadUntilClosed().code, websocket::close_code::policy_error);
+}
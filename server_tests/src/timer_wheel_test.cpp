@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+#include "../../server/include/timer_wheel.h"
+
+namespace {
+    std::vector<uint64_t> AdvanceBy(TimerWheel& wheel, const size_t ticks) {
+        std::vector<uint64_t> expired;
+        for (size_t i = 0; i < ticks; ++i) {
+            wheel.Advance(expired);
+        }
+        return expired;
+    }
+}
+
+TEST(TimerWheelTest, ExpiresAfterRequestedTicks) {
+    TimerWheel wheel(8);
+    wheel.Schedule(3, 42);
+
+    EXPECT_TRUE(AdvanceBy(wheel, 2).empty());
+    EXPECT_EQ(AdvanceBy(wheel, 1), std::vector<uint64_t>{42});
+    EXPECT_EQ(wheel.Size(), 0);
+}
+
+TEST(TimerWheelTest, HandlesDelaysLongerThanOneRevolution) {
+    TimerWheel wheel(4);
+    wheel.Schedule(4, 1);
+    wheel.Schedule(9, 2);
+
+    EXPECT_EQ(AdvanceBy(wheel, 4), std::vector<uint64_t>{1});
+    EXPECT_TRUE(AdvanceBy(wheel, 4).empty());
+    EXPECT_EQ(AdvanceBy(wheel, 1), std::vector<uint64_t>{2});
+}
+
+TEST(TimerWheelTest, CancelRemovesTimer) {
+    TimerWheel wheel(8);
+    const auto handle = wheel.Schedule(2, 7);
+    wheel.Schedule(2, 8);
+
+    uint64_t payload = 0;
+    EXPECT_TRUE(wheel.Cancel(handle, &payload));
+    EXPECT_EQ(payload, 7);
+    EXPECT_FALSE(wheel.Cancel(handle));
+    EXPECT_EQ(AdvanceBy(wheel, 2), std::vector<uint64_t>{8});
+}
+
+TEST(TimerWheelTest, StaleHandleDoesNotCancelReusedNode) {
+    TimerWheel wheel(8);
+    const auto first = wheel.Schedule(1, 1);
+    AdvanceBy(wheel, 1);
+
+    const auto second = wheel.Schedule(1, 2);
+    EXPECT_EQ(first.index, second.index);
+    EXPECT_FALSE(wheel.Cancel(first));
+    EXPECT_EQ(AdvanceBy(wheel, 1), std::vector<uint64_t>{2});
+}
+
+TEST(TimerWheelTest, ZeroDelayFiresOnNextTick) {
+    TimerWheel wheel(8);
+    wheel.Schedule(0, 5);
+
+    EXPECT_EQ(AdvanceBy(wheel, 1), std::vector<uint64_t>{5});
+}
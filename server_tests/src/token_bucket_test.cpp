@@ -0,0 +1,48 @@
+#include "gtest/gtest.h"
+#include "../../server/include/token_bucket.h"
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST(TokenBucketTest, UnlimitedNeverWaits) {
+    TokenBucket bucket;
+    EXPECT_FALSE(bucket.Limited());
+    EXPECT_EQ(bucket.Charge(1e12), TokenBucket::Clock::duration::zero());
+}
+
+TEST(TokenBucketTest, BurstIsFreeThenRateApplies) {
+    TokenBucket bucket({.per_second = 10, .burst = 5});
+    const auto now = TokenBucket::Clock::now();
+
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(bucket.Charge(1, now), TokenBucket::Clock::duration::zero());
+    }
+    EXPECT_EQ(bucket.Charge(1, now), 100ms);
+    EXPECT_EQ(bucket.Charge(1, now), 200ms);
+}
+
+TEST(TokenBucketTest, RefillsWhileIdle) {
+    TokenBucket bucket({.per_second = 100});
+    const auto now = TokenBucket::Clock::now();
+
+    EXPECT_EQ(bucket.Charge(150, now), 500ms);
+    EXPECT_EQ(bucket.Charge(0, now + 500ms), TokenBucket::Clock::duration::zero());
+    EXPECT_EQ(bucket.Charge(100, now + 1500ms), TokenBucket::Clock::duration::zero());
+}
+
+TEST(TokenBucketTest, ConcurrentChargesAreAllCounted) {
+    TokenBucket bucket({.per_second = 1000});
+    const auto now = TokenBucket::Clock::now();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&bucket, now] {
+            for (int i = 0; i < 1000; ++i) bucket.Charge(1, now);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    // 4000 tokens against a burst of 1000 leaves three seconds of debt.
+    EXPECT_EQ(bucket.Charge(0, now), 3s);
+}
@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+#include "../../server/include/wire_codec.h"
+#include "../../server/include/broadcast_message.h"
+
+TEST(WireCodecTest, RoomCommandRoundTrip) {
+    const RoomCommand command{"join", "lobby", "alice"};
+    const auto frame = WireCodec::EncodeRoomCommand(command);
+
+    WireCodec::RoomCommandView view;
+    ASSERT_TRUE(WireCodec::DecodeRoomCommand(frame, view));
+    EXPECT_EQ(view.operation, "join");
+    EXPECT_EQ(view.roomName, "lobby");
+    EXPECT_EQ(view.userName, "alice");
+}
+
+TEST(WireCodecTest, DecodedViewsPointIntoFrame) {
+    const auto frame = WireCodec::EncodeRoomMessage("bob", "hello there");
+
+    WireCodec::RoomMessageView view;
+    ASSERT_TRUE(WireCodec::DecodeRoomMessage(frame, view));
+    EXPECT_EQ(view.message, "hello there");
+    EXPECT_GE(view.message.data(), frame.data());
+    EXPECT_LE(view.message.data() + view.message.size(), frame.data() + frame.size());
+}
+
+TEST(WireCodecTest, RejectsTruncatedAndMistypedFrames) {
+    const auto frame = WireCodec::EncodeRoomMessage("bob", "hello");
+
+    WireCodec::RoomMessageView message;
+    EXPECT_FALSE(WireCodec::DecodeRoomMessage(std::string_view(frame).substr(0, frame.size() - 1), message));
+    EXPECT_FALSE(WireCodec::DecodeRoomMessage(frame + "x", message));
+
+    WireCodec::RoomCommandView command;
+    EXPECT_FALSE(WireCodec::DecodeRoomCommand(frame, command));
+    EXPECT_FALSE(WireCodec::DecodeRoomCommand("", command));
+}
+
+TEST(WireCodecTest, SelectsBinaryOnlyWhenOffered) {
+    EXPECT_EQ(WireCodec::SelectProtocol(""), WireProtocol::Json);
+    EXPECT_EQ(WireCodec::SelectProtocol("chat.json"), WireProtocol::Json);
+    EXPECT_EQ(WireCodec::SelectProtocol("chat.json, chat.binary.v1"), WireProtocol::Binary);
+    EXPECT_EQ(WireCodec::SelectProtocol("chat.binary.v2"), WireProtocol::Json);
+}
+
+TEST(WireCodecTest, OffersMatchesWholeTokens) {
+    EXPECT_TRUE(WireCodec::Offers("chat.json", WireCodec::kJsonSubprotocol));
+    EXPECT_TRUE(WireCodec::Offers("x-chat, \tchat.json ", WireCodec::kJsonSubprotocol));
+    EXPECT_FALSE(WireCodec::Offers("chat.jsonx", WireCodec::kJsonSubprotocol));
+    EXPECT_FALSE(WireCodec::Offers("x-chat.json", WireCodec::kJsonSubprotocol));
+    EXPECT_FALSE(WireCodec::Offers("chat.binary.v1x", WireCodec::kBinarySubprotocol));
+}
+
+TEST(WireCodecTest, BroadcastMessageTranscodesBetweenEncodings) {
+    const BroadcastMessage from_json("hi", WireProtocol::Json, "carol");
+    const auto binary = from_json.BufferFor(WireProtocol::Binary);
+
+    WireCodec::RoomMessageView view;
+    ASSERT_TRUE(WireCodec::DecodeRoomMessage({static_cast<const char*>(binary.data()), binary.size()}, view));
+    EXPECT_EQ(view.username, "carol");
+    EXPECT_EQ(view.message, "hi");
+
+    const BroadcastMessage from_binary(WireCodec::EncodeRoomMessage("dave", "yo"), WireProtocol::Binary);
+    const auto text = from_binary.BufferFor(WireProtocol::Json);
+    const auto json = nlohmann::json::parse(std::string(static_cast<const char*>(text.data()), text.size()));
+    EXPECT_EQ(json["username"], "dave");
+    EXPECT_EQ(json["message"], "yo");
+}
+
+TEST(WireCodecTest, RoomMessageBatchRoundTrip) {
+    const std::string first = WireCodec::EncodeRoomMessage("a", "one");
+    const std::string second = WireCodec::EncodeRoomMessage("b", "two");
+    const std::string batch = WireCodec::EncodeRoomMessageBatch({first, second});
+
+    std::vector<std::string_view> frames;
+    ASSERT_TRUE(WireCodec::DecodeRoomMessageBatch(batch, frames));
+    ASSERT_EQ(frames.size(), 2);
+    EXPECT_EQ(frames[0], first);
+    EXPECT_EQ(frames[1], second);
+
+    EXPECT_FALSE(WireCodec::DecodeRoomMessageBatch(batch.substr(0, batch.size() - 1), frames));
+    EXPECT_FALSE(WireCodec::DecodeRoomMessageBatch(first, frames));
+}
+
+TEST(WireCodecTest, BatchMessageCarriesBothEncodings) {
+    const auto from_json = MakeBroadcastMessage(R"({"username":"carol","message":"hi"})", WireProtocol::Json, "carol");
+    const auto from_binary = MakeBroadcastMessage(WireCodec::EncodeRoomMessage("dave", "yo"), WireProtocol::Binary, "dave");
+    const auto batch = MakeBatchMessage({from_json, from_binary});
+
+    const auto json = nlohmann::json::parse(batch->Data());
+    ASSERT_TRUE(json.is_array());
+    ASSERT_EQ(json.size(), 2);
+    EXPECT_EQ(json[0]["message"], "hi");
+    EXPECT_EQ(json[1]["username"], "dave");
+
+    const auto binary = batch->BufferFor(WireProtocol::Binary);
+    std::vector<std::string_view> frames;
+    ASSERT_TRUE(WireCodec::DecodeRoomMessageBatch({static_cast<const char*>(binary.data()), binary.size()}, frames));
+    ASSERT_EQ(frames.size(), 2);
+    EXPECT_EQ(frames[1], from_binary->Data());
+
+    WireCodec::RoomMessageView view;
+    ASSERT_TRUE(WireCodec::DecodeRoomMessage(frames[0], view));
+    EXPECT_EQ(view.username, "carol");
+}
+
+TEST(WireCodecTest, BatchQuotesPayloadsThatAreNotJson) {
+    const auto plain = MakeBroadcastMessage("1234 not \"json\"", WireProtocol::Json, "erin");
+    const auto object = MakeBroadcastMessage(R"({"username":"frank","message":"ok"})", WireProtocol::Json, "frank");
+    const auto batch = MakeBatchMessage({plain, object});
+
+    const auto json = nlohmann::json::parse(batch->Data());
+    ASSERT_TRUE(json.is_array());
+    ASSERT_EQ(json.size(), 2);
+    EXPECT_EQ(json[0], "1234 not \"json\"");
+    EXPECT_EQ(json[1]["username"], "frank");
+    EXPECT_EQ(batch->Size(), plain->Size() + object->Size() + 3);
+}